@@ -0,0 +1,230 @@
+#include "ClusteredLighting.h"
+#include "ThreadPool.h"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CLUSTER_USE_SSE 1
+#endif
+
+namespace {
+
+struct LightSphere {
+    float x, y, z, r;
+};
+
+// Ограничивающая сфера источника в view space
+LightSphere GetViewSphere(const Light& light, const float view[16]) {
+    float cx = light.position[0];
+    float cy = light.position[1];
+    float cz = light.position[2];
+    float r = light.range;
+
+    if (light.type == LightType::Spot) {
+        float cosA = std::clamp(light.spotCosAngle, 0.0f, 1.0f);
+        float offset;
+        if (cosA < 0.70710678f) {
+            offset = light.range * cosA;
+            r = light.range * sqrtf(1.0f - cosA * cosA);
+        }
+        else {
+            offset = light.range / (2.0f * cosA);
+            r = offset;
+        }
+        cx += light.direction[0] * offset;
+        cy += light.direction[1] * offset;
+        cz += light.direction[2] * offset;
+    }
+
+    LightSphere s;
+    s.x = cx * view[0] + cy * view[4] + cz * view[8] + view[12];
+    s.y = cx * view[1] + cy * view[5] + cz * view[9] + view[13];
+    s.z = cx * view[2] + cy * view[6] + cz * view[10] + view[14];
+    s.r = r;
+    return s;
+}
+
+bool SphereIntersectsAABB(const LightSphere& s, const float* mn, const float* mx) {
+    float dx = std::max(mn[0] - s.x, 0.0f) + std::max(s.x - mx[0], 0.0f);
+    float dy = std::max(mn[1] - s.y, 0.0f) + std::max(s.y - mx[1], 0.0f);
+    float dz = std::max(mn[2] - s.z, 0.0f) + std::max(s.z - mx[2], 0.0f);
+    return dx * dx + dy * dy + dz * dz <= s.r * s.r;
+}
+
+// Кандидаты среза в SoA, длина кратна 4
+struct LightBatch {
+    std::vector<float> x, y, z, r2;
+    std::vector<uint32_t> index;
+
+    void Push(const LightSphere& s, uint32_t i) {
+        x.push_back(s.x); y.push_back(s.y); z.push_back(s.z); r2.push_back(s.r * s.r); index.push_back(i);
+    }
+
+    void Pad() {
+        while (x.size() % 4 != 0) {
+            x.push_back(1e30f); y.push_back(1e30f); z.push_back(1e30f); r2.push_back(-1.0f); index.push_back(0);
+        }
+    }
+};
+
+// Тест 4 источников против AABB кластера, результат - маска из 4 бит
+int TestBatch4(const LightBatch& b, size_t i, const float* mn, const float* mx) {
+#ifdef CLUSTER_USE_SSE
+    __m128 zero = _mm_setzero_ps();
+    __m128 px = _mm_loadu_ps(&b.x[i]);
+    __m128 py = _mm_loadu_ps(&b.y[i]);
+    __m128 pz = _mm_loadu_ps(&b.z[i]);
+    __m128 dx = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(mn[0]), px), zero), _mm_max_ps(_mm_sub_ps(px, _mm_set1_ps(mx[0])), zero));
+    __m128 dy = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(mn[1]), py), zero), _mm_max_ps(_mm_sub_ps(py, _mm_set1_ps(mx[1])), zero));
+    __m128 dz = _mm_add_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(mn[2]), pz), zero), _mm_max_ps(_mm_sub_ps(pz, _mm_set1_ps(mx[2])), zero));
+    __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    return _mm_movemask_ps(_mm_cmple_ps(d2, _mm_loadu_ps(&b.r2[i])));
+#else
+    int mask = 0;
+    for (int k = 0; k < 4; ++k) {
+        float dx = std::max(mn[0] - b.x[i + k], 0.0f) + std::max(b.x[i + k] - mx[0], 0.0f);
+        float dy = std::max(mn[1] - b.y[i + k], 0.0f) + std::max(b.y[i + k] - mx[1], 0.0f);
+        float dz = std::max(mn[2] - b.z[i + k], 0.0f) + std::max(b.z[i + k] - mx[2], 0.0f);
+        if (dx * dx + dy * dy + dz * dz <= b.r2[i + k]) mask |= 1 << k;
+    }
+    return mask;
+#endif
+}
+
+}
+
+void UpdateClusterGrid(ClusterGrid& grid, float fov, float aspect, float nearZ, float farZ) {
+    if (!grid.aabbMin.empty() && grid.fov == fov && grid.aspect == aspect && grid.nearZ == nearZ && grid.farZ == farZ) {
+        return;
+    }
+
+    grid.fov = fov;
+    grid.aspect = aspect;
+    grid.nearZ = nearZ;
+    grid.farZ = farZ;
+
+    grid.sliceDepth.resize(grid.slicesZ + 1);
+    for (uint32_t z = 0; z <= grid.slicesZ; ++z) {
+        grid.sliceDepth[z] = nearZ * powf(farZ / nearZ, (float)z / grid.slicesZ);
+    }
+
+    uint32_t count = grid.ClusterCount();
+    grid.aabbMin.resize(count * 3);
+    grid.aabbMax.resize(count * 3);
+
+    float tanY = tanf(fov / 2.0f);
+    float tanX = tanY * aspect;
+
+    for (uint32_t z = 0; z < grid.slicesZ; ++z) {
+        float zn = grid.sliceDepth[z];
+        float zf = grid.sliceDepth[z + 1];
+        for (uint32_t y = 0; y < grid.tilesY; ++y) {
+            // Тайл 0 - верх экрана
+            float ny1 = 1.0f - 2.0f * y / grid.tilesY;
+            float ny0 = 1.0f - 2.0f * (y + 1) / grid.tilesY;
+            for (uint32_t x = 0; x < grid.tilesX; ++x) {
+                float nx0 = -1.0f + 2.0f * x / grid.tilesX;
+                float nx1 = -1.0f + 2.0f * (x + 1) / grid.tilesX;
+
+                uint32_t c = (z * grid.tilesY + y) * grid.tilesX + x;
+                float* mn = &grid.aabbMin[c * 3];
+                float* mx = &grid.aabbMax[c * 3];
+                mn[0] = std::min(nx0 * tanX * zn, nx0 * tanX * zf);
+                mx[0] = std::max(nx1 * tanX * zn, nx1 * tanX * zf);
+                mn[1] = std::min(ny0 * tanY * zn, ny0 * tanY * zf);
+                mx[1] = std::max(ny1 * tanY * zn, ny1 * tanY * zf);
+                mn[2] = zn;
+                mx[2] = zf;
+            }
+        }
+    }
+}
+
+void AssignLights(const ClusterGrid& grid, const std::vector<Light>& lights, const float view[16], ClusterLightList& out) {
+    uint32_t clusterCount = grid.ClusterCount();
+    uint32_t clustersPerSlice = grid.tilesX * grid.tilesY;
+    out.offsets.assign(clusterCount * 2, 0);
+    out.indices.clear();
+    if (lights.empty()) return;
+
+    std::vector<LightSphere> spheres(lights.size());
+    const size_t TransformBlock = 1024;
+    ParallelFor((lights.size() + TransformBlock - 1) / TransformBlock, [&](size_t block) {
+        size_t end = std::min(lights.size(), (block + 1) * TransformBlock);
+        for (size_t i = block * TransformBlock; i < end; ++i) {
+            spheres[i] = GetViewSphere(lights[i], view);
+        }
+    });
+
+    // Каждый срез пишет в свой список, затем склеиваем
+    std::vector<std::vector<uint32_t>> sliceIndices(grid.slicesZ);
+
+    ParallelFor(grid.slicesZ, [&](size_t z) {
+        float zn = grid.sliceDepth[z];
+        float zf = grid.sliceDepth[z + 1];
+
+        LightBatch batch;
+        for (size_t i = 0; i < spheres.size(); ++i) {
+            const LightSphere& s = spheres[i];
+            if (s.z + s.r >= zn && s.z - s.r <= zf) {
+                batch.Push(s, static_cast<uint32_t>(i));
+            }
+        }
+        if (batch.x.empty()) return;
+        batch.Pad();
+
+        std::vector<uint32_t>& list = sliceIndices[z];
+        for (uint32_t c = 0; c < clustersPerSlice; ++c) {
+            uint32_t cluster = static_cast<uint32_t>(z) * clustersPerSlice + c;
+            const float* mn = &grid.aabbMin[cluster * 3];
+            const float* mx = &grid.aabbMax[cluster * 3];
+
+            uint32_t start = static_cast<uint32_t>(list.size());
+            for (size_t i = 0; i < batch.x.size(); i += 4) {
+                int mask = TestBatch4(batch, i, mn, mx);
+                if (mask == 0) continue;
+                for (int k = 0; k < 4; ++k) {
+                    if (mask & (1 << k)) list.push_back(batch.index[i + k]);
+                }
+            }
+            out.offsets[cluster * 2 + 0] = start;
+            out.offsets[cluster * 2 + 1] = static_cast<uint32_t>(list.size()) - start;
+        }
+    });
+
+    size_t total = 0;
+    for (const std::vector<uint32_t>& list : sliceIndices) total += list.size();
+    out.indices.reserve(total);
+
+    for (uint32_t z = 0; z < grid.slicesZ; ++z) {
+        uint32_t base = static_cast<uint32_t>(out.indices.size());
+        for (uint32_t c = 0; c < clustersPerSlice; ++c) {
+            out.offsets[(z * clustersPerSlice + c) * 2] += base;
+        }
+        out.indices.insert(out.indices.end(), sliceIndices[z].begin(), sliceIndices[z].end());
+    }
+}
+
+void AssignLightsReference(const ClusterGrid& grid, const std::vector<Light>& lights, const float view[16], ClusterLightList& out) {
+    uint32_t clusterCount = grid.ClusterCount();
+    out.offsets.assign(clusterCount * 2, 0);
+    out.indices.clear();
+
+    std::vector<LightSphere> spheres(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i) {
+        spheres[i] = GetViewSphere(lights[i], view);
+    }
+
+    for (uint32_t c = 0; c < clusterCount; ++c) {
+        uint32_t start = static_cast<uint32_t>(out.indices.size());
+        for (size_t i = 0; i < spheres.size(); ++i) {
+            if (SphereIntersectsAABB(spheres[i], &grid.aabbMin[c * 3], &grid.aabbMax[c * 3])) {
+                out.indices.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        out.offsets[c * 2 + 0] = start;
+        out.offsets[c * 2 + 1] = static_cast<uint32_t>(out.indices.size()) - start;
+    }
+}
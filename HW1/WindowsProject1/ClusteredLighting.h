@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class LightType : uint32_t {
+    Point,
+    Spot,
+};
+
+// Позиция и направление в мировых координатах
+struct Light {
+    float position[3];
+    float range;
+    float direction[3];
+    float spotCosAngle;
+    float color[3];
+    LightType type;
+};
+
+// Froxel-сетка: тайлы экрана по X/Y и экспоненциальные срезы по глубине
+struct ClusterGrid {
+    uint32_t tilesX = 16;
+    uint32_t tilesY = 9;
+    uint32_t slicesZ = 24;
+    float fov = 0.0f;
+    float aspect = 0.0f;
+    float nearZ = 0.0f;
+    float farZ = 0.0f;
+
+    // AABB кластеров в view space, индекс (z * tilesY + y) * tilesX + x
+    std::vector<float> aabbMin;
+    std::vector<float> aabbMax;
+    std::vector<float> sliceDepth;
+
+    uint32_t ClusterCount() const { return tilesX * tilesY * slicesZ; }
+};
+
+// Готово к загрузке в StructuredBuffer: для кластера c свет с индексами
+// indices[offsets[c * 2] .. offsets[c * 2] + offsets[c * 2 + 1])
+struct ClusterLightList {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> indices;
+};
+
+// Перестраивает AABB только если параметры проекции изменились
+void UpdateClusterGrid(ClusterGrid& grid, float fov, float aspect, float nearZ, float farZ);
+
+// view - row-major матрица вида (конвенция DirectXMath, LH, вектор-строка)
+void AssignLights(const ClusterGrid& grid, const std::vector<Light>& lights, const float view[16], ClusterLightList& out);
+
+// Эталон без SIMD и потоков: каждый свет против каждого кластера
+void AssignLightsReference(const ClusterGrid& grid, const std::vector<Light>& lights, const float view[16], ClusterLightList& out);
@@ -0,0 +1,239 @@
+#include "Meshlet.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+struct Float3 {
+    float x, y, z;
+};
+
+Float3 Sub(const Float3& a, const Float3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+Float3 Cross(const Float3& a, const Float3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+float Dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+Float3 Normalize(const Float3& v) {
+    float len = sqrtf(Dot(v, v));
+    if (len == 0.0f) return { 0.0f, 0.0f, 0.0f };
+    return { v.x / len, v.y / len, v.z / len };
+}
+
+Float3 LoadPosition(const float* positions, size_t stride, uint32_t index) {
+    const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + stride * index);
+    return { p[0], p[1], p[2] };
+}
+
+MeshletBounds ComputeBounds(const float* positions, size_t stride, const uint32_t* vertices,
+    const uint8_t* triangles, size_t vertexCount, size_t triangleCount) {
+    MeshletBounds bounds = {};
+
+    // Сфера по центру AABB, затем радиус по самой дальней вершине
+    Float3 minP = LoadPosition(positions, stride, vertices[0]);
+    Float3 maxP = minP;
+    for (size_t i = 1; i < vertexCount; ++i) {
+        Float3 p = LoadPosition(positions, stride, vertices[i]);
+        minP = { std::min(minP.x, p.x), std::min(minP.y, p.y), std::min(minP.z, p.z) };
+        maxP = { std::max(maxP.x, p.x), std::max(maxP.y, p.y), std::max(maxP.z, p.z) };
+    }
+    Float3 center = { (minP.x + maxP.x) * 0.5f, (minP.y + maxP.y) * 0.5f, (minP.z + maxP.z) * 0.5f };
+    float radiusSq = 0.0f;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        Float3 d = Sub(LoadPosition(positions, stride, vertices[i]), center);
+        radiusSq = std::max(radiusSq, Dot(d, d));
+    }
+
+    bounds.center[0] = center.x;
+    bounds.center[1] = center.y;
+    bounds.center[2] = center.z;
+    bounds.radius = sqrtf(radiusSq);
+
+    // Конус нормалей
+    std::vector<Float3> normals(triangleCount);
+    std::vector<Float3> corners(triangleCount);
+    Float3 axis = { 0.0f, 0.0f, 0.0f };
+    for (size_t t = 0; t < triangleCount; ++t) {
+        Float3 p0 = LoadPosition(positions, stride, vertices[triangles[t * 3 + 0]]);
+        Float3 p1 = LoadPosition(positions, stride, vertices[triangles[t * 3 + 1]]);
+        Float3 p2 = LoadPosition(positions, stride, vertices[triangles[t * 3 + 2]]);
+        Float3 n = Normalize(Cross(Sub(p1, p0), Sub(p2, p0)));
+        normals[t] = n;
+        corners[t] = p0;
+        axis = { axis.x + n.x, axis.y + n.y, axis.z + n.z };
+    }
+    axis = Normalize(axis);
+
+    float minDot = 1.0f;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        minDot = std::min(minDot, Dot(normals[t], axis));
+    }
+
+    bounds.coneAxis[0] = axis.x;
+    bounds.coneAxis[1] = axis.y;
+    bounds.coneAxis[2] = axis.z;
+
+    // Разброс нормалей больше 90 градусов: меслет никогда не отсекается
+    if (minDot <= 0.0f || Dot(axis, axis) == 0.0f) {
+        bounds.coneApex[0] = center.x;
+        bounds.coneApex[1] = center.y;
+        bounds.coneApex[2] = center.z;
+        bounds.coneCutoff = 1.0f;
+        return bounds;
+    }
+
+    // Вершина конуса сдвигается назад вдоль оси так, чтобы лежать позади всех плоскостей треугольников
+    float maxT = 0.0f;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        float dc = Dot(Sub(center, corners[t]), normals[t]);
+        float dn = Dot(axis, normals[t]);
+        maxT = std::max(maxT, dc / dn);
+    }
+
+    bounds.coneApex[0] = center.x - axis.x * maxT;
+    bounds.coneApex[1] = center.y - axis.y * maxT;
+    bounds.coneApex[2] = center.z - axis.z * maxT;
+    bounds.coneCutoff = sqrtf(1.0f - minDot * minDot);
+    return bounds;
+}
+
+}
+
+IndexFormat ChooseIndexFormat(size_t vertexCount) {
+    return vertexCount <= 0x10000 ? IndexFormat::Uint16 : IndexFormat::Uint32;
+}
+
+void PackIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount, IndexData& out) {
+    out.format = ChooseIndexFormat(vertexCount);
+    out.count = static_cast<uint32_t>(indexCount);
+    out.bytes.resize(indexCount * out.Stride());
+
+    if (out.format == IndexFormat::Uint32) {
+        memcpy(out.bytes.data(), indices, indexCount * sizeof(uint32_t));
+        return;
+    }
+
+    uint16_t* dst = reinterpret_cast<uint16_t*>(out.bytes.data());
+    for (size_t i = 0; i < indexCount; ++i) {
+        dst[i] = static_cast<uint16_t>(indices[i]);
+    }
+}
+
+void BuildMeshlets(const float* positions, size_t vertexCount, size_t positionStride,
+    const uint32_t* indices, size_t indexCount, MeshletData& out,
+    size_t maxVertices, size_t maxTriangles) {
+    out.meshlets.clear();
+    out.bounds.clear();
+    out.vertices.clear();
+    out.triangles.clear();
+
+    maxVertices = std::min<size_t>(std::max<size_t>(maxVertices, 3), 255);
+    maxTriangles = std::min<size_t>(std::max<size_t>(maxTriangles, 1), 255);
+
+    // Локальный индекс вершины в текущем меслете, 0xff - ещё не добавлена
+    std::vector<uint8_t> localIndex(vertexCount, 0xff);
+
+    Meshlet current = {};
+
+    auto flush = [&]() {
+        if (current.triangleCount == 0) return;
+        for (uint32_t i = 0; i < current.vertexCount; ++i) {
+            localIndex[out.vertices[current.vertexOffset + i]] = 0xff;
+        }
+        out.bounds.push_back(ComputeBounds(positions, positionStride,
+            &out.vertices[current.vertexOffset], &out.triangles[current.triangleOffset],
+            current.vertexCount, current.triangleCount));
+        out.meshlets.push_back(current);
+
+        current = {};
+        current.vertexOffset = static_cast<uint32_t>(out.vertices.size());
+        current.triangleOffset = static_cast<uint32_t>(out.triangles.size());
+    };
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        uint32_t a = indices[i + 0];
+        uint32_t b = indices[i + 1];
+        uint32_t c = indices[i + 2];
+
+        size_t newVertices = (localIndex[a] == 0xff) + (localIndex[b] == 0xff) + (localIndex[c] == 0xff);
+        if (current.vertexCount + newVertices > maxVertices || current.triangleCount + 1u > maxTriangles) {
+            flush();
+        }
+
+        for (uint32_t v : { a, b, c }) {
+            if (localIndex[v] == 0xff) {
+                localIndex[v] = current.vertexCount++;
+                out.vertices.push_back(v);
+            }
+            out.triangles.push_back(localIndex[v]);
+        }
+        current.triangleCount++;
+    }
+    flush();
+}
+
+void ExtractFrustumPlanes(const float vp[16], float planes[6][4]) {
+    // clip = v * M, столбец j матрицы: vp[i * 4 + j]
+    auto column = [&](int j, float c[4]) {
+        for (int i = 0; i < 4; ++i) c[i] = vp[i * 4 + j];
+    };
+    float c0[4], c1[4], c2[4], c3[4];
+    column(0, c0);
+    column(1, c1);
+    column(2, c2);
+    column(3, c3);
+
+    for (int i = 0; i < 4; ++i) {
+        planes[0][i] = c3[i] + c0[i]; // left
+        planes[1][i] = c3[i] - c0[i]; // right
+        planes[2][i] = c3[i] + c1[i]; // bottom
+        planes[3][i] = c3[i] - c1[i]; // top
+        planes[4][i] = c2[i];         // near (D3D: 0 <= z)
+        planes[5][i] = c3[i] - c2[i]; // far
+    }
+
+    for (int p = 0; p < 6; ++p) {
+        float len = sqrtf(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+        if (len > 0.0f) {
+            for (int i = 0; i < 4; ++i) planes[p][i] /= len;
+        }
+    }
+}
+
+bool IsMeshletBackfacing(const MeshletBounds& bounds, const float cameraPos[3]) {
+    Float3 view = Normalize({ bounds.coneApex[0] - cameraPos[0], bounds.coneApex[1] - cameraPos[1], bounds.coneApex[2] - cameraPos[2] });
+    Float3 axis = { bounds.coneAxis[0], bounds.coneAxis[1], bounds.coneAxis[2] };
+    return Dot(view, axis) >= bounds.coneCutoff;
+}
+
+bool IsMeshletOutsideFrustum(const MeshletBounds& bounds, const float planes[6][4]) {
+    for (int p = 0; p < 6; ++p) {
+        float d = planes[p][0] * bounds.center[0] + planes[p][1] * bounds.center[1] + planes[p][2] * bounds.center[2] + planes[p][3];
+        if (d < -bounds.radius) return true;
+    }
+    return false;
+}
+
+MeshletCullStats CullMeshlets(const MeshletData& data, const float vp[16], const float cameraPos[3],
+    std::vector<uint32_t>& visible) {
+    float planes[6][4];
+    ExtractFrustumPlanes(vp, planes);
+
+    MeshletCullStats stats;
+    stats.total = static_cast<uint32_t>(data.meshlets.size());
+    visible.clear();
+
+    for (uint32_t i = 0; i < stats.total; ++i) {
+        const MeshletBounds& bounds = data.bounds[i];
+        if (IsMeshletOutsideFrustum(bounds, planes)) {
+            stats.frustumCulled++;
+            continue;
+        }
+        if (IsMeshletBackfacing(bounds, cameraPos)) {
+            stats.backfaceCulled++;
+            continue;
+        }
+        visible.push_back(i);
+    }
+    return stats;
+}
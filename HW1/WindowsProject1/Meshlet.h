@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Индексы: 16 бит пока хватает вершин, иначе 32 бита
+enum class IndexFormat : uint8_t {
+    Uint16,
+    Uint32,
+};
+
+struct IndexData {
+    IndexFormat format = IndexFormat::Uint16;
+    uint32_t count = 0;
+    std::vector<uint8_t> bytes;
+
+    uint32_t Stride() const { return format == IndexFormat::Uint16 ? 2u : 4u; }
+};
+
+IndexFormat ChooseIndexFormat(size_t vertexCount);
+void PackIndices(const uint32_t* indices, size_t indexCount, size_t vertexCount, IndexData& out);
+
+// Meshlet: до maxVertices уникальных вершин и maxTriangles треугольников.
+// Треугольники хранятся локальными 8-битными индексами в вершинный список меслета.
+struct Meshlet {
+    uint32_t vertexOffset;
+    uint32_t triangleOffset;
+    uint8_t vertexCount;
+    uint8_t triangleCount;
+};
+
+// Сфера для frustum culling и конус нормалей для back-face culling.
+// Меслет невидим, если dot(normalize(apex - cameraPos), coneAxis) >= coneCutoff.
+struct MeshletBounds {
+    float center[3];
+    float radius;
+    float coneApex[3];
+    float coneCutoff;
+    float coneAxis[3];
+    float pad;
+};
+
+struct MeshletData {
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshletBounds> bounds;
+    std::vector<uint32_t> vertices;
+    std::vector<uint8_t> triangles;
+};
+
+const size_t MeshletMaxVertices = 64;
+const size_t MeshletMaxTriangles = 124;
+
+// positions: float3 с шагом positionStride байт
+void BuildMeshlets(const float* positions, size_t vertexCount, size_t positionStride,
+    const uint32_t* indices, size_t indexCount, MeshletData& out,
+    size_t maxVertices = MeshletMaxVertices, size_t maxTriangles = MeshletMaxTriangles);
+
+// Плоскости ax + by + cz + d >= 0 внутри, нормализованные.
+// vp - row-major матрица view * proj (конвенция DirectXMath, вектор-строка).
+void ExtractFrustumPlanes(const float vp[16], float planes[6][4]);
+
+bool IsMeshletBackfacing(const MeshletBounds& bounds, const float cameraPos[3]);
+bool IsMeshletOutsideFrustum(const MeshletBounds& bounds, const float planes[6][4]);
+
+struct MeshletCullStats {
+    uint32_t total = 0;
+    uint32_t frustumCulled = 0;
+    uint32_t backfaceCulled = 0;
+};
+
+// Заполняет visible индексами видимых меслетов
+MeshletCullStats CullMeshlets(const MeshletData& data, const float vp[16], const float cameraPos[3],
+    std::vector<uint32_t>& visible);
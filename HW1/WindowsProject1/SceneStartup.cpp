@@ -0,0 +1,172 @@
+#include "SceneStartup.h"
+#include "SphericalHarmonics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+const float Pi = 3.14159265358979f;
+
+}
+
+void GenerateSphere(uint32_t latLines, uint32_t longLines, std::vector<float>& positions, std::vector<uint32_t>& indices) {
+    float phiStep = Pi / latLines;
+    float thetaStep = 2.0f * Pi / longLines;
+
+    auto push = [&positions](float x, float y, float z) {
+        positions.push_back(x);
+        positions.push_back(y);
+        positions.push_back(z);
+    };
+
+    push(0.0f, 1.0f, 0.0f);
+    for (uint32_t i = 1; i <= latLines - 1; ++i) {
+        float phi = i * phiStep;
+        for (uint32_t j = 0; j <= longLines; ++j) {
+            float theta = j * thetaStep;
+            push(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+        }
+    }
+    push(0.0f, -1.0f, 0.0f);
+
+    for (uint32_t i = 1; i <= longLines; ++i) {
+        indices.push_back(0);
+        indices.push_back(i + 1);
+        indices.push_back(i);
+    }
+
+    uint32_t baseIndex = 1;
+    uint32_t ringVertexCount = longLines + 1;
+    for (uint32_t i = 0; i < latLines - 2; ++i) {
+        for (uint32_t j = 0; j < longLines; ++j) {
+            indices.push_back(baseIndex + i * ringVertexCount + j);
+            indices.push_back(baseIndex + i * ringVertexCount + j + 1);
+            indices.push_back(baseIndex + (i + 1) * ringVertexCount + j);
+
+            indices.push_back(baseIndex + (i + 1) * ringVertexCount + j);
+            indices.push_back(baseIndex + i * ringVertexCount + j + 1);
+            indices.push_back(baseIndex + (i + 1) * ringVertexCount + j + 1);
+        }
+    }
+
+    uint32_t southPoleIndex = static_cast<uint32_t>(positions.size() / 3) - 1;
+    baseIndex = southPoleIndex - ringVertexCount;
+    for (uint32_t i = 0; i < longLines; ++i) {
+        indices.push_back(southPoleIndex);
+        indices.push_back(baseIndex + i);
+        indices.push_back(baseIndex + i + 1);
+    }
+}
+
+bool ComputeAmbientSH(const DDSImage& skybox, float out[9][4]) {
+    const uint32_t AmbientMip = 2;
+    uint32_t mip = std::min(AmbientMip, skybox.mipCount - 1);
+
+    CubemapImage cubemap;
+    if (!DecodeCubemap(skybox.fmt, skybox.data.data(), skybox.width, skybox.height, skybox.mipCount, mip, cubemap)) {
+        return false;
+    }
+    PackIrradianceSH(ProjectCubemapSH(cubemap), out);
+    return true;
+}
+
+bool PrepareSpecularCubemap(SceneStartupData& data) {
+    const DDSImage& skybox = data.skyboxTexture;
+    PrefilterSettings settings;
+    PrefilterCacheKey key;
+    bool hasKey = !data.specularCachePath.empty() && MakePrefilterCacheKey(data.skyboxPath, settings, key);
+    if (hasKey && IsPrefilterCacheValid(data.specularCachePath, key) && LoadDDSFile(data.specularCachePath, data.specularTexture)) {
+        data.specularFromCache = true;
+        return true;
+    }
+
+    CubemapImage source;
+    if (!DecodeCubemap(skybox.fmt, skybox.data.data(), skybox.width, skybox.height, skybox.mipCount, 0, source)) {
+        return false;
+    }
+
+    std::vector<CubemapImage> mips;
+    PrefilterSpecularCubemap(source, settings, mips, &data.specularStats);
+
+    if (data.writeCache && hasKey) {
+        data.specularCacheSaved = SaveCubemapMipsDDS(data.specularCachePath, mips, &key);
+    }
+
+    DDSImage& out = data.specularTexture;
+    PackCubemapMipsBGRA8(mips, out.data);
+    out.fmt = TexelFormat::BGRA8;
+    out.width = mips[0].size;
+    out.height = mips[0].size;
+    out.mipCount = static_cast<uint32_t>(mips.size());
+    out.isCubemap = true;
+    return true;
+}
+
+SceneStartupTasks AddSceneStartupTasks(TaskGraph& graph, SceneStartupData& data) {
+    SceneStartupTasks tasks;
+
+    tasks.sphere = graph.Add("generate sphere", [&data] {
+        std::vector<float> positions;
+        std::vector<uint32_t> indices;
+        GenerateSphere(20, 20, positions, indices);
+        size_t vertexCount = positions.size() / 3;
+        PackIndices(indices.data(), indices.size(), vertexCount, data.sphereIndices);
+
+        ComputeQuantizationBounds(positions.data(), vertexCount, sizeof(float) * 3, data.sphereBounds);
+        data.sphereVertices.resize(vertexCount * 4);
+        QuantizePositionsSnorm16(positions.data(), vertexCount, sizeof(float) * 3, data.sphereBounds,
+            data.sphereVertices.data(), sizeof(int16_t) * 4);
+    });
+
+    tasks.cubeTexture = graph.Add("load vect.dds", [&data] {
+        data.cubeLoaded = LoadDDSFile(data.cubePath, data.cubeTexture);
+    });
+
+    tasks.skyboxTexture = graph.Add("load skybox.dds", [&data] {
+        data.skyboxLoaded = LoadDDSFile(data.skyboxPath, data.skyboxTexture);
+    });
+
+    tasks.ambientSH = graph.Add("skybox ambient SH", [&data] {
+        if (data.skyboxLoaded) data.ambientReady = ComputeAmbientSH(data.skyboxTexture, data.ambientSH);
+    }, { tasks.skyboxTexture });
+
+    tasks.specular = graph.Add("skybox specular", [&data] {
+        if (data.skyboxLoaded) data.specularReady = PrepareSpecularCubemap(data);
+    }, { tasks.skyboxTexture });
+
+    return tasks;
+}
+
+std::string RunHeadlessStartup(const std::filesystem::path& assetsDir, const std::filesystem::path& specularCachePath,
+    const AddStartupTasksFn& addShaderTasks) {
+    auto makeData = [&](SceneStartupData& data) {
+        data.cubePath = assetsDir / "vect.dds";
+        data.skyboxPath = assetsDir / "skybox.dds";
+        data.specularCachePath = specularCachePath;
+        data.writeCache = false;
+    };
+
+    TaskGraph serialGraph;
+    SceneStartupData serialData;
+    makeData(serialData);
+    if (addShaderTasks) addShaderTasks(serialGraph);
+    AddSceneStartupTasks(serialGraph, serialData);
+    serialGraph.RunSerial();
+
+    TaskGraph parallelGraph;
+    SceneStartupData parallelData;
+    makeData(parallelData);
+    if (addShaderTasks) addShaderTasks(parallelGraph);
+    AddSceneStartupTasks(parallelGraph, parallelData);
+    parallelGraph.Run();
+
+    char line[128];
+    snprintf(line, sizeof(line), "Serial: wall %.1f ms\n", serialGraph.GetWallMs());
+    std::string report = line + parallelGraph.Report(&serialGraph);
+    if (!addShaderTasks) report += "Shader compile: not measured (D3DCompile is not available in this build)\n";
+    if (!parallelData.cubeLoaded) report += "Failed to load: " + parallelData.cubePath.string() + "\n";
+    if (!parallelData.skyboxLoaded) report += "Failed to load: " + parallelData.skyboxPath.string() + "\n";
+    return report;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Meshlet.h"
+#include "SpecularPrefilter.h"
+#include "TaskGraph.h"
+#include "TextureData.h"
+#include "VertexQuantization.h"
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Стадии старта, которые не трогают устройство: сфера skybox, загрузка DDS, SH и префильтр.
+// Приложение добавляет к ним свои задачи создания ресурсов, headless-замер запускает их отдельно.
+struct SceneStartupData {
+    std::filesystem::path cubePath;
+    std::filesystem::path skyboxPath;
+    // Пустой путь - кэш префильтра не читается и не пишется
+    std::filesystem::path specularCachePath;
+    bool writeCache = true;
+
+    // Позиции snorm16, по 4 компоненты на вершину
+    std::vector<int16_t> sphereVertices;
+    QuantizationBounds sphereBounds;
+    IndexData sphereIndices;
+
+    DDSImage cubeTexture;
+    DDSImage skyboxTexture;
+    DDSImage specularTexture;
+    bool cubeLoaded = false;
+    bool skyboxLoaded = false;
+    bool specularReady = false;
+    bool specularFromCache = false;
+    bool specularCacheSaved = false;
+    PrefilterStats specularStats;
+
+    float ambientSH[9][4] = {};
+    bool ambientReady = false;
+};
+
+struct SceneStartupTasks {
+    TaskGraph::TaskId sphere;
+    TaskGraph::TaskId cubeTexture;
+    TaskGraph::TaskId skyboxTexture;
+    TaskGraph::TaskId ambientSH;
+    TaskGraph::TaskId specular;
+};
+
+// Пути в data задаются до запуска графа
+SceneStartupTasks AddSceneStartupTasks(TaskGraph& graph, SceneStartupData& data);
+
+// Единичная сфера с полюсами, позиции float3
+void GenerateSphere(uint32_t latLines, uint32_t longLines, std::vector<float>& positions, std::vector<uint32_t>& indices);
+
+// Проекция skybox на SH9; для низких частот хватает уменьшенного мипа
+bool ComputeAmbientSH(const DDSImage& skybox, float out[9][4]);
+
+// Отражения из data.skyboxTexture: мипы по roughness. Кэш используется, только если его ключ
+// совпадает с исходником и настройками, иначе считаем заново и при writeCache перезаписываем.
+bool PrepareSpecularCubemap(SceneStartupData& data);
+
+// Добавляет в граф стадии, которых нет в SceneStartup (компиляция шейдеров в приложении).
+// Вызывается один раз на каждый из двух графов замера.
+using AddStartupTasksFn = std::function<void(TaskGraph& graph)>;
+
+// Стадии CPU сначала по очереди (вложенные ParallelFor тоже), затем графом.
+// Кэш префильтра только читается. Возвращает отчёт TaskGraph::Report.
+// Без addShaderTasks компиляция шейдеров не входит в замер, об этом есть строка в отчёте.
+std::string RunHeadlessStartup(const std::filesystem::path& assetsDir,
+    const std::filesystem::path& specularCachePath = std::filesystem::path(),
+    const AddStartupTasksFn& addShaderTasks = AddStartupTasksFn());
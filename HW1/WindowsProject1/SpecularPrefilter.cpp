@@ -0,0 +1,361 @@
+#include "SpecularPrefilter.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const float Pi = 3.14159265358979f;
+const uint32_t TileSize = 32;
+const uint32_t CacheTag = 0x31465053; // "SPF1"
+
+struct PrefilterSample {
+    float l[3];     // направление в касательном пространстве, N = (0, 0, 1)
+    float weight;   // N.L
+    float lod;      // мип источника по pdf выборки
+};
+
+float RadicalInverse(uint32_t bits) {
+    bits = (bits << 16) | (bits >> 16);
+    bits = ((bits & 0x55555555u) << 1) | ((bits & 0xAAAAAAAAu) >> 1);
+    bits = ((bits & 0x33333333u) << 2) | ((bits & 0xCCCCCCCCu) >> 2);
+    bits = ((bits & 0x0F0F0F0Fu) << 4) | ((bits & 0xF0F0F0F0u) >> 4);
+    bits = ((bits & 0x00FF00FFu) << 8) | ((bits & 0xFF00FF00u) >> 8);
+    return bits * 2.3283064365386963e-10f;
+}
+
+// Importance sampling GGX при N = V = R, lod по методу filtered importance sampling
+std::vector<PrefilterSample> BuildSamples(float roughness, uint32_t sampleCount, uint32_t sourceSize) {
+    float a = roughness * roughness;
+    float a2 = a * a;
+    float texelSolidAngle = 4.0f * Pi / (6.0f * sourceSize * sourceSize);
+
+    std::vector<PrefilterSample> samples;
+    samples.reserve(sampleCount);
+    for (uint32_t i = 0; i < sampleCount; ++i) {
+        float xi0 = (float)i / sampleCount;
+        float xi1 = RadicalInverse(i);
+
+        float phi = 2.0f * Pi * xi0;
+        float cosTheta = sqrtf((1.0f - xi1) / (1.0f + (a2 - 1.0f) * xi1));
+        float sinTheta = sqrtf(1.0f - cosTheta * cosTheta);
+        float h[3] = { sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta };
+
+        // L = reflect(-V, H) при V = N
+        PrefilterSample s;
+        s.l[0] = 2.0f * cosTheta * h[0];
+        s.l[1] = 2.0f * cosTheta * h[1];
+        s.l[2] = 2.0f * cosTheta * h[2] - 1.0f;
+        s.weight = s.l[2];
+        if (s.weight <= 0.0f) continue;
+
+        float d = cosTheta * cosTheta * (a2 - 1.0f) + 1.0f;
+        float ggx = a2 / (Pi * d * d);
+        float pdf = ggx * 0.25f;
+        float sampleSolidAngle = 1.0f / (sampleCount * pdf + 1e-6f);
+        s.lod = std::max(0.0f, 0.5f * log2f(sampleSolidAngle / texelSolidAngle) + 1.0f);
+        samples.push_back(s);
+    }
+    return samples;
+}
+
+void Downsample(const CubemapImage& src, CubemapImage& dst) {
+    dst.size = std::max(1u, src.size / 2);
+    for (int face = 0; face < 6; ++face) {
+        dst.faces[face].resize(static_cast<size_t>(dst.size) * dst.size * 4);
+    }
+
+    ParallelFor(6, [&](size_t face) {
+        const float* s = src.faces[face].data();
+        float* d = dst.faces[face].data();
+        for (uint32_t y = 0; y < dst.size; ++y) {
+            uint32_t y0 = std::min(y * 2, src.size - 1), y1 = std::min(y * 2 + 1, src.size - 1);
+            for (uint32_t x = 0; x < dst.size; ++x) {
+                uint32_t x0 = std::min(x * 2, src.size - 1), x1 = std::min(x * 2 + 1, src.size - 1);
+                for (int c = 0; c < 4; ++c) {
+                    d[(y * dst.size + x) * 4 + c] = 0.25f * (
+                        s[(y0 * src.size + x0) * 4 + c] + s[(y0 * src.size + x1) * 4 + c] +
+                        s[(y1 * src.size + x0) * 4 + c] + s[(y1 * src.size + x1) * 4 + c]);
+                }
+            }
+        }
+    });
+}
+
+void SampleBilinear(const CubemapImage& image, int face, float u, float v, float rgb[3]) {
+    float fx = std::clamp((u * 0.5f + 0.5f) * image.size - 0.5f, 0.0f, (float)(image.size - 1));
+    float fy = std::clamp((v * 0.5f + 0.5f) * image.size - 0.5f, 0.0f, (float)(image.size - 1));
+    uint32_t x0 = (uint32_t)fx, y0 = (uint32_t)fy;
+    uint32_t x1 = std::min(x0 + 1, image.size - 1), y1 = std::min(y0 + 1, image.size - 1);
+    float tx = fx - x0, ty = fy - y0;
+
+    const float* p = image.faces[face].data();
+    for (int c = 0; c < 3; ++c) {
+        float top = p[(y0 * image.size + x0) * 4 + c] * (1.0f - tx) + p[(y0 * image.size + x1) * 4 + c] * tx;
+        float bottom = p[(y1 * image.size + x0) * 4 + c] * (1.0f - tx) + p[(y1 * image.size + x1) * 4 + c] * tx;
+        rgb[c] = top * (1.0f - ty) + bottom * ty;
+    }
+}
+
+void SampleTrilinear(const std::vector<CubemapImage>& chain, const float dir[3], float lod, float rgb[3]) {
+    float u, v;
+    int face = CubemapDirectionToFace(dir, u, v);
+
+    lod = std::clamp(lod, 0.0f, (float)(chain.size() - 1));
+    uint32_t m0 = (uint32_t)lod;
+    uint32_t m1 = std::min(m0 + 1, (uint32_t)chain.size() - 1);
+    float t = lod - m0;
+
+    SampleBilinear(chain[m0], face, u, v, rgb);
+    if (t > 0.0f && m1 != m0) {
+        float rgb1[3];
+        SampleBilinear(chain[m1], face, u, v, rgb1);
+        for (int c = 0; c < 3; ++c) rgb[c] += (rgb1[c] - rgb[c]) * t;
+    }
+}
+
+void FilterTile(const std::vector<CubemapImage>& chain, const std::vector<PrefilterSample>& samples, float mirrorLod,
+    CubemapImage& dst, int face, uint32_t tileX, uint32_t tileY) {
+    const float texelSize = 2.0f / dst.size;
+    uint32_t xEnd = std::min(tileX + TileSize, dst.size);
+    uint32_t yEnd = std::min(tileY + TileSize, dst.size);
+
+    for (uint32_t y = tileY; y < yEnd; ++y) {
+        for (uint32_t x = tileX; x < xEnd; ++x) {
+            float n[3];
+            CubemapTexelDirection(face, (x + 0.5f) * texelSize - 1.0f, (y + 0.5f) * texelSize - 1.0f, n);
+            float invLen = 1.0f / sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int c = 0; c < 3; ++c) n[c] *= invLen;
+
+            float* out = &dst.faces[face][(static_cast<size_t>(y) * dst.size + x) * 4];
+            out[3] = 1.0f;
+
+            if (samples.empty()) {
+                SampleTrilinear(chain, n, mirrorLod, out);
+                continue;
+            }
+
+            float up[3] = { 0.0f, 0.0f, 1.0f };
+            if (fabsf(n[2]) > 0.999f) {
+                up[0] = 1.0f;
+                up[2] = 0.0f;
+            }
+            float t[3] = { up[1] * n[2] - up[2] * n[1], up[2] * n[0] - up[0] * n[2], up[0] * n[1] - up[1] * n[0] };
+            float tLen = 1.0f / sqrtf(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+            for (int c = 0; c < 3; ++c) t[c] *= tLen;
+            float b[3] = { n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0] };
+
+            float sum[3] = {};
+            float weight = 0.0f;
+            for (const PrefilterSample& s : samples) {
+                float l[3];
+                for (int c = 0; c < 3; ++c) l[c] = t[c] * s.l[0] + b[c] * s.l[1] + n[c] * s.l[2];
+                float rgb[3];
+                SampleTrilinear(chain, l, s.lod, rgb);
+                for (int c = 0; c < 3; ++c) sum[c] += rgb[c] * s.weight;
+                weight += s.weight;
+            }
+            for (int c = 0; c < 3; ++c) out[c] = sum[c] / weight;
+        }
+    }
+}
+
+// Граничный тексель грани и соседний тексель через ребро получают одинаковое среднее
+void FixupEdges(CubemapImage& image) {
+    uint32_t size = image.size;
+    if (size < 2) {
+        float avg[4] = {};
+        for (int face = 0; face < 6; ++face) {
+            for (int c = 0; c < 4; ++c) avg[c] += image.faces[face][c] / 6.0f;
+        }
+        for (int face = 0; face < 6; ++face) {
+            for (int c = 0; c < 4; ++c) image.faces[face][c] = avg[c];
+        }
+        return;
+    }
+
+    CubemapImage source = image;
+    const float texelSize = 2.0f / size;
+    const float Outside = 1.0f + 0.5f * texelSize;
+
+    ParallelFor(6, [&](size_t face) {
+        for (uint32_t y = 0; y < size; ++y) {
+            for (uint32_t x = 0; x < size; ++x) {
+                bool edgeX = x == 0 || x == size - 1;
+                bool edgeY = y == 0 || y == size - 1;
+                if (!edgeX && !edgeY) continue;
+
+                float u = (x + 0.5f) * texelSize - 1.0f;
+                float v = (y + 0.5f) * texelSize - 1.0f;
+
+                float* out = &image.faces[face][(static_cast<size_t>(y) * size + x) * 4];
+                const float* self = &source.faces[face][(static_cast<size_t>(y) * size + x) * 4];
+                float sum[4] = { self[0], self[1], self[2], self[3] };
+                float count = 1.0f;
+
+                // Шаг за ребро по u и/или по v попадает на соседнюю грань
+                for (int axis = 0; axis < 2; ++axis) {
+                    if ((axis == 0 && !edgeX) || (axis == 1 && !edgeY)) continue;
+                    float su = axis == 0 ? (x == 0 ? -Outside : Outside) : u;
+                    float sv = axis == 1 ? (y == 0 ? -Outside : Outside) : v;
+
+                    float dir[3];
+                    CubemapTexelDirection(static_cast<int>(face), su, sv, dir);
+                    float nu, nv;
+                    int neighbour = CubemapDirectionToFace(dir, nu, nv);
+                    uint32_t nx = std::min((uint32_t)((nu * 0.5f + 0.5f) * size), size - 1);
+                    uint32_t ny = std::min((uint32_t)((nv * 0.5f + 0.5f) * size), size - 1);
+
+                    const float* other = &source.faces[neighbour][(static_cast<size_t>(ny) * size + nx) * 4];
+                    for (int c = 0; c < 4; ++c) sum[c] += other[c];
+                    count += 1.0f;
+                }
+
+                for (int c = 0; c < 4; ++c) out[c] = sum[c] / count;
+            }
+        }
+    });
+}
+
+void PackCacheKey(const PrefilterCacheKey& key, uint32_t reserved[11]) {
+    memset(reserved, 0, sizeof(uint32_t) * 11);
+    reserved[0] = CacheTag;
+    reserved[1] = static_cast<uint32_t>(key.sourceSize);
+    reserved[2] = static_cast<uint32_t>(key.sourceSize >> 32);
+    reserved[3] = static_cast<uint32_t>(key.sourceTime);
+    reserved[4] = static_cast<uint32_t>(key.sourceTime >> 32);
+    reserved[5] = key.outputSize;
+    reserved[6] = key.mipCount;
+    reserved[7] = key.sampleCount;
+}
+
+}
+
+void PrefilterSpecularCubemap(const CubemapImage& source, const PrefilterSettings& settings,
+    std::vector<CubemapImage>& mips, PrefilterStats* stats) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    // Цепочка источника для выборок с lod
+    std::vector<CubemapImage> chain(1, source);
+    while (chain.back().size > 1) {
+        CubemapImage next;
+        Downsample(chain.back(), next);
+        chain.push_back(std::move(next));
+    }
+
+    uint32_t maxMips = 1;
+    while ((settings.outputSize >> maxMips) > 0) ++maxMips;
+    uint32_t mipCount = std::clamp(settings.mipCount, 1u, maxMips);
+
+    std::vector<std::vector<PrefilterSample>> samples(mipCount);
+    mips.assign(mipCount, CubemapImage());
+    for (uint32_t m = 0; m < mipCount; ++m) {
+        mips[m].size = std::max(1u, settings.outputSize >> m);
+        for (int face = 0; face < 6; ++face) {
+            mips[m].faces[face].resize(static_cast<size_t>(mips[m].size) * mips[m].size * 4);
+        }
+        if (m > 0) {
+            float roughness = (float)m / (mipCount - 1);
+            samples[m] = BuildSamples(roughness, settings.sampleCount, source.size);
+        }
+    }
+
+    // Мип 0 - копия источника, уменьшенная до размера выхода
+    float mirrorLod = std::max(0.0f, log2f((float)source.size / settings.outputSize));
+
+    struct Job {
+        uint32_t mip;
+        int face;
+        uint32_t tileX, tileY;
+    };
+    std::vector<Job> jobs;
+    for (uint32_t m = 0; m < mipCount; ++m) {
+        for (int face = 0; face < 6; ++face) {
+            for (uint32_t ty = 0; ty < mips[m].size; ty += TileSize) {
+                for (uint32_t tx = 0; tx < mips[m].size; tx += TileSize) {
+                    jobs.push_back({ m, face, tx, ty });
+                }
+            }
+        }
+    }
+
+    ParallelFor(jobs.size(), [&](size_t i) {
+        const Job& job = jobs[i];
+        FilterTile(chain, samples[job.mip], mirrorLod, mips[job.mip], job.face, job.tileX, job.tileY);
+    });
+
+    ParallelFor(mipCount, [&](size_t m) {
+        FixupEdges(mips[m]);
+    });
+
+    if (stats) {
+        stats->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        stats->samples = 0;
+        for (uint32_t m = 0; m < mipCount; ++m) {
+            uint64_t texels = 6ull * mips[m].size * mips[m].size;
+            stats->samples += texels * std::max<size_t>(1, samples[m].size());
+        }
+    }
+}
+
+void PackCubemapMipsBGRA8(const std::vector<CubemapImage>& mips, std::vector<uint8_t>& data) {
+    data.clear();
+    for (int face = 0; face < 6; ++face) {
+        for (const CubemapImage& mip : mips) {
+            const std::vector<float>& src = mip.faces[face];
+            size_t base = data.size();
+            data.resize(base + src.size());
+            for (size_t i = 0; i < src.size(); i += 4) {
+                uint8_t* dst = &data[base + i];
+                dst[0] = (uint8_t)(std::clamp(src[i + 2], 0.0f, 1.0f) * 255.0f + 0.5f);
+                dst[1] = (uint8_t)(std::clamp(src[i + 1], 0.0f, 1.0f) * 255.0f + 0.5f);
+                dst[2] = (uint8_t)(std::clamp(src[i + 0], 0.0f, 1.0f) * 255.0f + 0.5f);
+                dst[3] = (uint8_t)(std::clamp(src[i + 3], 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    }
+}
+
+bool MakePrefilterCacheKey(const std::filesystem::path& source, const PrefilterSettings& settings, PrefilterCacheKey& key) {
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(source, error);
+    if (error) return false;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(source, error);
+    if (error) return false;
+
+    key.sourceSize = static_cast<uint64_t>(size);
+    key.sourceTime = static_cast<uint64_t>(time.time_since_epoch().count());
+    key.outputSize = settings.outputSize;
+    key.mipCount = settings.mipCount;
+    key.sampleCount = settings.sampleCount;
+    return true;
+}
+
+bool IsPrefilterCacheValid(const std::filesystem::path& cache, const PrefilterCacheKey& key) {
+    std::ifstream file(cache, std::ios::binary);
+    uint32_t magic = 0;
+    DDS_HEADER header = {};
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || magic != DDS_MAGIC) return false;
+
+    uint32_t expected[11];
+    PackCacheKey(key, expected);
+    return memcmp(header.dwReserved1, expected, sizeof(expected)) == 0;
+}
+
+bool SaveCubemapMipsDDS(const std::filesystem::path& path, const std::vector<CubemapImage>& mips,
+    const PrefilterCacheKey* key) {
+    if (mips.empty()) return false;
+    std::vector<uint8_t> data;
+    PackCubemapMipsBGRA8(mips, data);
+
+    uint32_t reserved[11] = {};
+    if (key) PackCacheKey(*key, reserved);
+    return SaveDDS(path, TexelFormat::BGRA8, mips[0].size, mips[0].size, static_cast<uint32_t>(mips.size()), true,
+        data.data(), data.size(), reserved);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "TextureData.h"
+
+struct PrefilterSettings {
+    uint32_t outputSize = 128;
+    uint32_t mipCount = 6;
+    uint32_t sampleCount = 64;
+};
+
+struct PrefilterStats {
+    double milliseconds = 0.0;
+    uint64_t samples = 0;
+};
+
+// Мип m соответствует roughness = m / (mipCount - 1), мип 0 - зеркальное отражение.
+// Параллельно по мипам, граням и тайлам 32x32, затем сшивка рёбер между гранями.
+void PrefilterSpecularCubemap(const CubemapImage& source, const PrefilterSettings& settings,
+    std::vector<CubemapImage>& mips, PrefilterStats* stats = nullptr);
+
+// Цепочка в BGRA8 в раскладке LoadDDS (грани подряд, в каждой все мипы)
+void PackCubemapMipsBGRA8(const std::vector<CubemapImage>& mips, std::vector<uint8_t>& data);
+
+// Ключ кэша: размер и время изменения исходника плюс настройки фильтрации.
+// Хранится в dwReserved1 заголовка DDS, при несовпадении кэш считается устаревшим.
+struct PrefilterCacheKey {
+    uint64_t sourceSize = 0;
+    uint64_t sourceTime = 0;
+    uint32_t outputSize = 0;
+    uint32_t mipCount = 0;
+    uint32_t sampleCount = 0;
+};
+
+bool MakePrefilterCacheKey(const std::filesystem::path& source, const PrefilterSettings& settings, PrefilterCacheKey& key);
+bool IsPrefilterCacheValid(const std::filesystem::path& cache, const PrefilterCacheKey& key);
+
+bool SaveCubemapMipsDDS(const std::filesystem::path& path, const std::vector<CubemapImage>& mips,
+    const PrefilterCacheKey* key = nullptr);
@@ -0,0 +1,227 @@
+#include "SphericalHarmonics.h"
+#include "ThreadPool.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SH_USE_SSE 1
+#endif
+
+namespace {
+
+const float Pi = 3.14159265358979f;
+
+const float Y0 = 0.282095f;
+const float Y1 = 0.488603f;
+const float Y2 = 1.092548f;
+const float Y20 = 0.315392f;
+const float Y22 = 0.546274f;
+
+void EvaluateBasis(float x, float y, float z, float b[9]) {
+    b[0] = Y0;
+    b[1] = Y1 * y;
+    b[2] = Y1 * z;
+    b[3] = Y1 * x;
+    b[4] = Y2 * x * y;
+    b[5] = Y2 * y * z;
+    b[6] = Y20 * (3.0f * z * z - 1.0f);
+    b[7] = Y2 * x * z;
+    b[8] = Y22 * (x * x - y * y);
+}
+
+float AreaElement(float x, float y) {
+    return atan2f(x * y, sqrtf(x * x + y * y + 1.0f));
+}
+
+// Частичная сумма одной грани и сумма весов текселей
+struct FaceSum {
+    double c[9][3] = {};
+    double weight = 0.0;
+};
+
+void AccumulateTexel(FaceSum& sum, const float* texel, float x, float y, float z, float w) {
+    float b[9];
+    EvaluateBasis(x, y, z, b);
+    for (int i = 0; i < 9; ++i) {
+        for (int ch = 0; ch < 3; ++ch) {
+            sum.c[i][ch] += static_cast<double>(b[i] * w * texel[ch]);
+        }
+    }
+    sum.weight += w;
+}
+
+void ProjectFace(const CubemapImage& cubemap, int face, FaceSum& sum) {
+    const uint32_t size = cubemap.size;
+    const float* pixels = cubemap.faces[face].data();
+    const float texelSize = 2.0f / size;
+    const float texelArea = texelSize * texelSize;
+
+    for (uint32_t ty = 0; ty < size; ++ty) {
+        float v = (ty + 0.5f) * texelSize - 1.0f;
+        const float* row = pixels + static_cast<size_t>(ty) * size * 4;
+        uint32_t tx = 0;
+
+#ifdef SH_USE_SSE
+        // Построчные суммы во float, в double переносим раз в строку
+        __m128 acc[9][3];
+        for (int i = 0; i < 9; ++i) {
+            for (int ch = 0; ch < 3; ++ch) acc[i][ch] = _mm_setzero_ps();
+        }
+        __m128 accWeight = _mm_setzero_ps();
+
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 vv = _mm_set1_ps(v);
+        const __m128 step = _mm_set1_ps(4.0f * texelSize);
+
+        // Направление линейно по u: rowBase + u * axisU
+        float rowBase[3], axisU[3];
+        CubemapTexelDirection(face, 0.0f, v, rowBase);
+        CubemapTexelDirection(face, 1.0f, v, axisU);
+        for (int i = 0; i < 3; ++i) axisU[i] -= rowBase[i];
+
+        __m128 u = _mm_setr_ps(0.5f * texelSize - 1.0f, 1.5f * texelSize - 1.0f, 2.5f * texelSize - 1.0f, 3.5f * texelSize - 1.0f);
+
+        for (; tx + 4 <= size; tx += 4, u = _mm_add_ps(u, step)) {
+            __m128 dx = _mm_add_ps(_mm_set1_ps(rowBase[0]), _mm_mul_ps(u, _mm_set1_ps(axisU[0])));
+            __m128 dy = _mm_add_ps(_mm_set1_ps(rowBase[1]), _mm_mul_ps(u, _mm_set1_ps(axisU[1])));
+            __m128 dz = _mm_add_ps(_mm_set1_ps(rowBase[2]), _mm_mul_ps(u, _mm_set1_ps(axisU[2])));
+
+            // 1 + u^2 + v^2, телесный угол = texelArea / (1 + u^2 + v^2)^(3/2)
+            __m128 len2 = _mm_add_ps(one, _mm_add_ps(_mm_mul_ps(u, u), _mm_mul_ps(vv, vv)));
+            __m128 invLen = _mm_div_ps(one, _mm_sqrt_ps(len2));
+            __m128 w = _mm_mul_ps(_mm_set1_ps(texelArea), _mm_mul_ps(invLen, _mm_mul_ps(invLen, invLen)));
+
+            __m128 x = _mm_mul_ps(dx, invLen);
+            __m128 y = _mm_mul_ps(dy, invLen);
+            __m128 z = _mm_mul_ps(dz, invLen);
+
+            __m128 b[9];
+            b[0] = _mm_set1_ps(Y0);
+            b[1] = _mm_mul_ps(_mm_set1_ps(Y1), y);
+            b[2] = _mm_mul_ps(_mm_set1_ps(Y1), z);
+            b[3] = _mm_mul_ps(_mm_set1_ps(Y1), x);
+            b[4] = _mm_mul_ps(_mm_set1_ps(Y2), _mm_mul_ps(x, y));
+            b[5] = _mm_mul_ps(_mm_set1_ps(Y2), _mm_mul_ps(y, z));
+            b[6] = _mm_mul_ps(_mm_set1_ps(Y20), _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3.0f), _mm_mul_ps(z, z)), one));
+            b[7] = _mm_mul_ps(_mm_set1_ps(Y2), _mm_mul_ps(x, z));
+            b[8] = _mm_mul_ps(_mm_set1_ps(Y22), _mm_sub_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+
+            // 4 текселя RGBA -> SoA
+            __m128 t0 = _mm_loadu_ps(row + (tx + 0) * 4);
+            __m128 t1 = _mm_loadu_ps(row + (tx + 1) * 4);
+            __m128 t2 = _mm_loadu_ps(row + (tx + 2) * 4);
+            __m128 t3 = _mm_loadu_ps(row + (tx + 3) * 4);
+            _MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+            __m128 color[3] = { _mm_mul_ps(t0, w), _mm_mul_ps(t1, w), _mm_mul_ps(t2, w) };
+
+            for (int i = 0; i < 9; ++i) {
+                for (int ch = 0; ch < 3; ++ch) {
+                    acc[i][ch] = _mm_add_ps(acc[i][ch], _mm_mul_ps(b[i], color[ch]));
+                }
+            }
+            accWeight = _mm_add_ps(accWeight, w);
+        }
+
+        float lanes[4];
+        for (int i = 0; i < 9; ++i) {
+            for (int ch = 0; ch < 3; ++ch) {
+                _mm_storeu_ps(lanes, acc[i][ch]);
+                sum.c[i][ch] += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+            }
+        }
+        _mm_storeu_ps(lanes, accWeight);
+        sum.weight += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+        for (; tx < size; ++tx) {
+            float u = (tx + 0.5f) * texelSize - 1.0f;
+            float d[3];
+            CubemapTexelDirection(face, u, v, d);
+            float len2 = 1.0f + u * u + v * v;
+            float invLen = 1.0f / sqrtf(len2);
+            float w = texelArea * invLen * invLen * invLen;
+            AccumulateTexel(sum, row + tx * 4, d[0] * invLen, d[1] * invLen, d[2] * invLen, w);
+        }
+    }
+}
+
+SH9Color Normalize(const FaceSum* faces) {
+    double c[9][3] = {};
+    double weight = 0.0;
+    for (int f = 0; f < 6; ++f) {
+        for (int i = 0; i < 9; ++i) {
+            for (int ch = 0; ch < 3; ++ch) c[i][ch] += faces[f].c[i][ch];
+        }
+        weight += faces[f].weight;
+    }
+
+    // Сумма весов должна быть 4pi, убираем ошибку дискретизации
+    double scale = weight > 0.0 ? 4.0 * Pi / weight : 0.0;
+    SH9Color sh;
+    for (int i = 0; i < 9; ++i) {
+        for (int ch = 0; ch < 3; ++ch) sh.c[i][ch] = static_cast<float>(c[i][ch] * scale);
+    }
+    return sh;
+}
+
+}
+
+SH9Color ProjectCubemapSH(const CubemapImage& cubemap) {
+    FaceSum faces[6];
+    ParallelFor(6, [&](size_t face) {
+        ProjectFace(cubemap, static_cast<int>(face), faces[face]);
+    });
+    return Normalize(faces);
+}
+
+SH9Color ProjectCubemapSHReference(const CubemapImage& cubemap) {
+    const uint32_t size = cubemap.size;
+    const float texelSize = 2.0f / size;
+
+    FaceSum faces[6];
+    for (int face = 0; face < 6; ++face) {
+        for (uint32_t ty = 0; ty < size; ++ty) {
+            for (uint32_t tx = 0; tx < size; ++tx) {
+                float u = (tx + 0.5f) * texelSize - 1.0f;
+                float v = (ty + 0.5f) * texelSize - 1.0f;
+                float x0 = u - texelSize * 0.5f, x1 = u + texelSize * 0.5f;
+                float y0 = v - texelSize * 0.5f, y1 = v + texelSize * 0.5f;
+                float w = AreaElement(x0, y0) - AreaElement(x0, y1) - AreaElement(x1, y0) + AreaElement(x1, y1);
+
+                float d[3];
+                CubemapTexelDirection(face, u, v, d);
+                float invLen = 1.0f / sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                AccumulateTexel(faces[face], &cubemap.faces[face][(static_cast<size_t>(ty) * size + tx) * 4],
+                    d[0] * invLen, d[1] * invLen, d[2] * invLen, w);
+            }
+        }
+    }
+    return Normalize(faces);
+}
+
+void PackIrradianceSH(const SH9Color& sh, float out[9][4]) {
+    // Свёртка с косинусом (Ramamoorthi & Hanrahan): A0 = pi, A1 = 2pi/3, A2 = pi/4.
+    // Делим на pi, чтобы получить диффузный отклик белой поверхности.
+    const float band[9] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+    const float basis[9] = { Y0, Y1, Y1, Y1, Y2, Y2, Y20, Y2, Y22 };
+
+    for (int i = 0; i < 9; ++i) {
+        for (int ch = 0; ch < 3; ++ch) {
+            out[i][ch] = sh.c[i][ch] * band[i] * basis[i];
+        }
+        out[i][3] = 0.0f;
+    }
+}
+
+void EvaluateIrradianceSH(const float packed[9][4], const float n[3], float rgb[3]) {
+    float poly[9] = {
+        1.0f, n[1], n[2], n[0],
+        n[0] * n[1], n[1] * n[2], 3.0f * n[2] * n[2] - 1.0f, n[0] * n[2], n[0] * n[0] - n[1] * n[1]
+    };
+    for (int ch = 0; ch < 3; ++ch) {
+        float v = 0.0f;
+        for (int i = 0; i < 9; ++i) v += packed[i][ch] * poly[i];
+        rgb[ch] = v;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "TextureData.h"
+
+// SH 2-го порядка (9 коэффициентов) на канал RGB
+struct SH9Color {
+    float c[9][3] = {};
+};
+
+// Проекция радиансы кубической карты, веса текселей - телесный угол
+SH9Color ProjectCubemapSH(const CubemapImage& cubemap);
+
+// Эталон: скалярный интеграл с точной площадью текселя на сфере
+SH9Color ProjectCubemapSHReference(const CubemapImage& cubemap);
+
+// Коэффициенты для шейдера: свёртка с косинусом и константы базиса уже внутри,
+// irradiance(n) = c0 + c1*n.y + c2*n.z + c3*n.x + c4*n.x*n.y + c5*n.y*n.z
+//               + c6*(3*n.z*n.z - 1) + c7*n.x*n.z + c8*(n.x*n.x - n.y*n.y)
+void PackIrradianceSH(const SH9Color& sh, float out[9][4]);
+
+void EvaluateIrradianceSH(const float packed[9][4], const float n[3], float rgb[3]);
@@ -0,0 +1,129 @@
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedMs(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+}
+
+TaskGraph::TaskId TaskGraph::Add(const char* name, std::function<void()> fn, std::initializer_list<TaskId> deps) {
+    TaskId id = m_tasks.size();
+    Task task;
+    task.name = name;
+    task.fn = std::move(fn);
+    task.depCount = deps.size();
+    m_tasks.push_back(std::move(task));
+    for (TaskId dep : deps) {
+        m_tasks[dep].dependents.push_back(id);
+    }
+    return id;
+}
+
+void TaskGraph::Run() {
+    m_timings.assign(m_tasks.size(), TaskTiming());
+    if (m_tasks.empty()) {
+        m_wallMs = 0.0;
+        return;
+    }
+
+    struct RunState {
+        std::unique_ptr<std::atomic<size_t>[]> pending;
+        size_t remaining = 0;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    RunState state;
+    state.pending.reset(new std::atomic<size_t>[m_tasks.size()]);
+    state.remaining = m_tasks.size();
+    for (size_t i = 0; i < m_tasks.size(); ++i) {
+        state.pending[i] = m_tasks[i].depCount;
+    }
+
+    Clock::time_point start = Clock::now();
+    ThreadPool& pool = GetThreadPool();
+
+    std::function<void(TaskId)> schedule = [&](TaskId id) {
+        pool.Submit([&, id] {
+            Clock::time_point taskStart = Clock::now();
+            m_tasks[id].fn();
+            Clock::time_point taskEnd = Clock::now();
+
+            TaskTiming& timing = m_timings[id];
+            timing.name = m_tasks[id].name;
+            timing.startMs = ElapsedMs(start, taskStart);
+            timing.durationMs = ElapsedMs(taskStart, taskEnd);
+
+            for (TaskId dependent : m_tasks[id].dependents) {
+                if (state.pending[dependent].fetch_sub(1) == 1) schedule(dependent);
+            }
+
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (--state.remaining == 0) state.cv.notify_all();
+        });
+    };
+
+    for (TaskId id = 0; id < m_tasks.size(); ++id) {
+        if (m_tasks[id].depCount == 0) schedule(id);
+    }
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&] { return state.remaining == 0; });
+    m_wallMs = ElapsedMs(start, Clock::now());
+}
+
+void TaskGraph::RunSerial() {
+    SerialScope serial;
+    m_timings.assign(m_tasks.size(), TaskTiming());
+    Clock::time_point start = Clock::now();
+
+    for (TaskId id = 0; id < m_tasks.size(); ++id) {
+        Clock::time_point taskStart = Clock::now();
+        m_tasks[id].fn();
+        Clock::time_point taskEnd = Clock::now();
+
+        m_timings[id].name = m_tasks[id].name;
+        m_timings[id].startMs = ElapsedMs(start, taskStart);
+        m_timings[id].durationMs = ElapsedMs(taskStart, taskEnd);
+    }
+    m_wallMs = ElapsedMs(start, Clock::now());
+}
+
+double TaskGraph::GetSerialSumMs() const {
+    double sum = 0.0;
+    for (const TaskTiming& timing : m_timings) sum += timing.durationMs;
+    return sum;
+}
+
+std::string TaskGraph::Report(const TaskGraph* serialBaseline) const {
+    std::string report;
+    char line[256];
+
+    if (serialBaseline) {
+        double serialMs = serialBaseline->GetSerialSumMs();
+        snprintf(line, sizeof(line), "Startup: wall %.1f ms, serial %.1f ms, x%.2f\n",
+            m_wallMs, serialMs, m_wallMs > 0.0 ? serialMs / m_wallMs : 0.0);
+    }
+    else {
+        snprintf(line, sizeof(line), "Startup: wall %.1f ms, sum of stages %.1f ms\n", m_wallMs, GetSerialSumMs());
+    }
+    report += line;
+
+    for (const TaskTiming& timing : m_timings) {
+        snprintf(line, sizeof(line), "  %-28s start %8.1f ms  took %8.1f ms\n",
+            timing.name.c_str(), timing.startMs, timing.durationMs);
+        report += line;
+    }
+    return report;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+struct TaskTiming {
+    std::string name;
+    double startMs = 0.0;
+    double durationMs = 0.0;
+};
+
+// Граф задач с зависимостями. Зависимости добавляются раньше зависящих задач,
+// поэтому порядок добавления - топологический.
+class TaskGraph {
+public:
+    using TaskId = size_t;
+
+    TaskId Add(const char* name, std::function<void()> fn, std::initializer_list<TaskId> deps = {});
+
+    // Готовые задачи уходят в пул потоков, вызывающий поток ждёт завершения всех
+    void Run();
+    // Те же задачи по очереди в порядке добавления, вложенные ParallelFor тоже без пула
+    void RunSerial();
+
+    const std::vector<TaskTiming>& GetTimings() const { return m_timings; }
+    double GetWallMs() const { return m_wallMs; }
+    double GetSerialSumMs() const;
+
+    // Ускорение считается относительно serialBaseline - того же графа после RunSerial.
+    // Без него в отчёте только время и сумма стадий этого запуска.
+    std::string Report(const TaskGraph* serialBaseline = nullptr) const;
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> fn;
+        std::vector<TaskId> dependents;
+        size_t depCount = 0;
+    };
+
+    std::vector<Task> m_tasks;
+    std::vector<TaskTiming> m_timings;
+    double m_wallMs = 0.0;
+};
@@ -0,0 +1,336 @@
+#include "TextureData.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+void Unpack565(uint16_t c, uint8_t rgba[4]) {
+    uint8_t r = (c >> 11) & 0x1f;
+    uint8_t g = (c >> 5) & 0x3f;
+    uint8_t b = c & 0x1f;
+    rgba[0] = (r << 3) | (r >> 2);
+    rgba[1] = (g << 2) | (g >> 4);
+    rgba[2] = (b << 3) | (b >> 2);
+    rgba[3] = 255;
+}
+
+void DecodeColorBlock(const uint8_t* block, uint8_t rgba[16][4], bool allowPunchThrough) {
+    uint16_t c0 = block[0] | (block[1] << 8);
+    uint16_t c1 = block[2] | (block[3] << 8);
+
+    uint8_t palette[4][4];
+    Unpack565(c0, palette[0]);
+    Unpack565(c1, palette[1]);
+
+    if (c0 > c1 || !allowPunchThrough) {
+        for (int i = 0; i < 3; ++i) {
+            palette[2][i] = static_cast<uint8_t>((2 * palette[0][i] + palette[1][i] + 1) / 3);
+            palette[3][i] = static_cast<uint8_t>((palette[0][i] + 2 * palette[1][i] + 1) / 3);
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 255;
+    }
+    else {
+        for (int i = 0; i < 3; ++i) {
+            palette[2][i] = static_cast<uint8_t>((palette[0][i] + palette[1][i]) / 2);
+            palette[3][i] = 0;
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 0;
+    }
+
+    uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+    for (int i = 0; i < 16; ++i) {
+        memcpy(rgba[i], palette[(bits >> (i * 2)) & 3], 4);
+    }
+}
+
+}
+
+bool IsBlockCompressed(TexelFormat fmt) {
+    return fmt == TexelFormat::BC1 || fmt == TexelFormat::BC2 || fmt == TexelFormat::BC3;
+}
+
+uint32_t GetBlockBytes(TexelFormat fmt) {
+    switch (fmt) {
+    case TexelFormat::BC1: return 8;
+    case TexelFormat::BC2:
+    case TexelFormat::BC3: return 16;
+    case TexelFormat::BGRA8: return 4;
+    default: return 0;
+    }
+}
+
+void GetSurfaceInfo(TexelFormat fmt, uint32_t width, uint32_t height, uint32_t& rowPitch, uint32_t& rowCount) {
+    if (IsBlockCompressed(fmt)) {
+        rowPitch = std::max(1u, (width + 3) / 4) * GetBlockBytes(fmt);
+        rowCount = std::max(1u, (height + 3) / 4);
+    }
+    else {
+        rowPitch = width * 4;
+        rowCount = height;
+    }
+}
+
+size_t GetSurfaceSize(TexelFormat fmt, uint32_t width, uint32_t height) {
+    uint32_t rowPitch = 0;
+    uint32_t rowCount = 0;
+    GetSurfaceInfo(fmt, width, height, rowPitch, rowCount);
+    return static_cast<size_t>(rowPitch) * rowCount;
+}
+
+size_t GetSubresourceOffset(TexelFormat fmt, uint32_t width, uint32_t height, uint32_t mipCount,
+    uint32_t arraySlice, uint32_t mip) {
+    size_t chainSize = 0;
+    size_t mipOffset = 0;
+    for (uint32_t m = 0; m < mipCount; ++m) {
+        if (m == mip) mipOffset = chainSize;
+        chainSize += GetSurfaceSize(fmt, std::max(1u, width >> m), std::max(1u, height >> m));
+    }
+    return chainSize * arraySlice + mipOffset;
+}
+
+bool SaveDDS(const std::filesystem::path& path, TexelFormat fmt, uint32_t width, uint32_t height,
+    uint32_t mipCount, bool isCubemap, const void* data, size_t dataSize, const uint32_t* reserved) {
+    DDS_HEADER header = {};
+    if (reserved) {
+        memcpy(header.dwReserved1, reserved, sizeof(header.dwReserved1));
+    }
+    header.dwSize = sizeof(DDS_HEADER);
+    header.dwFlags = 0x1 | 0x2 | 0x4 | 0x1000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT
+    header.dwHeight = height;
+    header.dwWidth = width;
+    header.dwMipMapCount = mipCount;
+    header.ddspf.dwSize = sizeof(DDS_PIXELFORMAT);
+    header.dwCaps = 0x1000; // TEXTURE
+
+    if (mipCount > 1) {
+        header.dwFlags |= 0x20000; // MIPMAPCOUNT
+        header.dwCaps |= 0x400000 | 0x8; // MIPMAP | COMPLEX
+    }
+    if (isCubemap) {
+        header.dwCaps |= 0x8; // COMPLEX
+        header.dwCaps2 = 0x200 | 0xfc00; // CUBEMAP | все 6 граней
+    }
+
+    switch (fmt) {
+    case TexelFormat::BC1: header.ddspf.dwFourCC = 0x31545844; break;
+    case TexelFormat::BC2: header.ddspf.dwFourCC = 0x33545844; break;
+    case TexelFormat::BC3: header.ddspf.dwFourCC = 0x35545844; break;
+    case TexelFormat::BGRA8:
+        header.ddspf.dwFlags = 0x40 | 0x1; // RGB | ALPHAPIXELS
+        header.ddspf.dwRGBBitCount = 32;
+        header.ddspf.dwRBitMask = 0x00ff0000;
+        header.ddspf.dwGBitMask = 0x0000ff00;
+        header.ddspf.dwBBitMask = 0x000000ff;
+        header.ddspf.dwABitMask = 0xff000000;
+        break;
+    default: return false;
+    }
+
+    uint32_t rowPitch = 0;
+    uint32_t rowCount = 0;
+    GetSurfaceInfo(fmt, width, height, rowPitch, rowCount);
+    if (IsBlockCompressed(fmt)) {
+        header.ddspf.dwFlags = 0x4; // FOURCC
+        header.dwFlags |= 0x80000; // LINEARSIZE
+        header.dwPitchOrLinearSize = rowPitch * rowCount;
+    }
+    else {
+        header.dwFlags |= 0x8; // PITCH
+        header.dwPitchOrLinearSize = rowPitch;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    uint32_t magic = DDS_MAGIC;
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(dataSize));
+    return file.good();
+}
+
+bool LoadDDSFile(const std::filesystem::path& path, DDSImage& image) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    uint32_t magic = 0;
+    DDS_HEADER header = {};
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || magic != DDS_MAGIC) return false;
+
+    image.width = header.dwWidth;
+    image.height = header.dwHeight;
+    image.mipCount = header.dwMipMapCount == 0 ? 1 : header.dwMipMapCount;
+    image.isCubemap = (header.dwCaps2 & 0x200) != 0; // CUBEMAP
+
+    if (header.ddspf.dwFlags & 0x4) { // FOURCC
+        switch (header.ddspf.dwFourCC) {
+        case 0x31545844: image.fmt = TexelFormat::BC1; break;
+        case 0x33545844: image.fmt = TexelFormat::BC2; break;
+        case 0x35545844: image.fmt = TexelFormat::BC3; break;
+        default: image.fmt = TexelFormat::Unknown; break;
+        }
+    }
+    else if (header.ddspf.dwRGBBitCount == 32) {
+        image.fmt = TexelFormat::BGRA8;
+    }
+    else {
+        image.fmt = TexelFormat::Unknown;
+    }
+    if (image.fmt == TexelFormat::Unknown) return false;
+
+    std::streamsize dataSize = size - static_cast<std::streamsize>(sizeof(magic) + sizeof(header));
+    size_t expected = GetSubresourceOffset(image.fmt, image.width, image.height, image.mipCount, image.isCubemap ? 6 : 1, 0);
+    if (dataSize < static_cast<std::streamsize>(expected)) return false;
+
+    image.data.resize(expected);
+    file.read(reinterpret_cast<char*>(image.data.data()), static_cast<std::streamsize>(expected));
+    return file.good();
+}
+
+void DecodeBC1Block(const uint8_t* block, uint8_t rgba[16][4]) {
+    DecodeColorBlock(block, rgba, true);
+}
+
+void DecodeBC2Block(const uint8_t* block, uint8_t rgba[16][4]) {
+    DecodeColorBlock(block + 8, rgba, false);
+    for (int i = 0; i < 16; ++i) {
+        uint8_t a = (block[i / 2] >> ((i & 1) * 4)) & 0xf;
+        rgba[i][3] = (a << 4) | a;
+    }
+}
+
+void DecodeBC3Block(const uint8_t* block, uint8_t rgba[16][4]) {
+    DecodeColorBlock(block + 8, rgba, false);
+
+    uint8_t alpha[8];
+    alpha[0] = block[0];
+    alpha[1] = block[1];
+    if (alpha[0] > alpha[1]) {
+        for (int i = 1; i < 7; ++i) {
+            alpha[i + 1] = static_cast<uint8_t>(((7 - i) * alpha[0] + i * alpha[1] + 3) / 7);
+        }
+    }
+    else {
+        for (int i = 1; i < 5; ++i) {
+            alpha[i + 1] = static_cast<uint8_t>(((5 - i) * alpha[0] + i * alpha[1] + 2) / 5);
+        }
+        alpha[6] = 0;
+        alpha[7] = 255;
+    }
+
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i) {
+        bits |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+    }
+    for (int i = 0; i < 16; ++i) {
+        rgba[i][3] = alpha[(bits >> (i * 3)) & 7];
+    }
+}
+
+bool DecodeSurface(TexelFormat fmt, const void* data, uint32_t width, uint32_t height, std::vector<float>& rgba) {
+    const float Scale = 1.0f / 255.0f;
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    rgba.resize(static_cast<size_t>(width) * height * 4);
+
+    if (fmt == TexelFormat::BGRA8) {
+        for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+            rgba[i * 4 + 0] = src[i * 4 + 2] * Scale;
+            rgba[i * 4 + 1] = src[i * 4 + 1] * Scale;
+            rgba[i * 4 + 2] = src[i * 4 + 0] * Scale;
+            rgba[i * 4 + 3] = src[i * 4 + 3] * Scale;
+        }
+        return true;
+    }
+
+    void (*decodeBlock)(const uint8_t*, uint8_t[16][4]) = nullptr;
+    switch (fmt) {
+    case TexelFormat::BC1: decodeBlock = DecodeBC1Block; break;
+    case TexelFormat::BC2: decodeBlock = DecodeBC2Block; break;
+    case TexelFormat::BC3: decodeBlock = DecodeBC3Block; break;
+    default: return false;
+    }
+
+    uint32_t blockBytes = GetBlockBytes(fmt);
+    uint32_t blocksX = std::max(1u, (width + 3) / 4);
+    uint32_t blocksY = std::max(1u, (height + 3) / 4);
+
+    for (uint32_t by = 0; by < blocksY; ++by) {
+        for (uint32_t bx = 0; bx < blocksX; ++bx) {
+            uint8_t texels[16][4];
+            decodeBlock(src + (static_cast<size_t>(by) * blocksX + bx) * blockBytes, texels);
+
+            for (uint32_t ty = 0; ty < 4; ++ty) {
+                uint32_t y = by * 4 + ty;
+                if (y >= height) break;
+                for (uint32_t tx = 0; tx < 4; ++tx) {
+                    uint32_t x = bx * 4 + tx;
+                    if (x >= width) break;
+                    float* dst = &rgba[(static_cast<size_t>(y) * width + x) * 4];
+                    for (int c = 0; c < 4; ++c) dst[c] = texels[ty * 4 + tx][c] * Scale;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool DecodeCubemap(TexelFormat fmt, const void* data, uint32_t width, uint32_t height, uint32_t mipCount,
+    uint32_t mip, CubemapImage& out) {
+    if (width != height || mip >= mipCount) return false;
+
+    out.size = std::max(1u, width >> mip);
+    bool ok[6] = {};
+    ParallelFor(6, [&](size_t face) {
+        size_t offset = GetSubresourceOffset(fmt, width, height, mipCount, static_cast<uint32_t>(face), mip);
+        ok[face] = DecodeSurface(fmt, static_cast<const uint8_t*>(data) + offset, out.size, out.size, out.faces[face]);
+    });
+    return std::all_of(ok, ok + 6, [](bool b) { return b; });
+}
+
+void CubemapTexelDirection(int face, float u, float v, float dir[3]) {
+    switch (face) {
+    case 0: dir[0] = 1.0f;  dir[1] = -v;    dir[2] = -u;    break;
+    case 1: dir[0] = -1.0f; dir[1] = -v;    dir[2] = u;     break;
+    case 2: dir[0] = u;     dir[1] = 1.0f;  dir[2] = v;     break;
+    case 3: dir[0] = u;     dir[1] = -1.0f; dir[2] = -v;    break;
+    case 4: dir[0] = u;     dir[1] = -v;    dir[2] = 1.0f;  break;
+    default: dir[0] = -u;   dir[1] = -v;    dir[2] = -1.0f; break;
+    }
+}
+
+int CubemapDirectionToFace(const float dir[3], float& u, float& v) {
+    float ax = fabsf(dir[0]);
+    float ay = fabsf(dir[1]);
+    float az = fabsf(dir[2]);
+
+    if (ax >= ay && ax >= az) {
+        float inv = 1.0f / ax;
+        v = -dir[1] * inv;
+        if (dir[0] > 0.0f) { u = -dir[2] * inv; return 0; }
+        u = dir[2] * inv;
+        return 1;
+    }
+    if (ay >= az) {
+        float inv = 1.0f / ay;
+        u = dir[0] * inv;
+        if (dir[1] > 0.0f) { v = dir[2] * inv; return 2; }
+        v = -dir[2] * inv;
+        return 3;
+    }
+    float inv = 1.0f / az;
+    v = -dir[1] * inv;
+    if (dir[2] > 0.0f) { u = dir[0] * inv; return 4; }
+    u = -dir[0] * inv;
+    return 5;
+}
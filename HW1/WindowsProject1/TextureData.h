@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+#define DDS_MAGIC 0x20534444
+
+struct DDS_PIXELFORMAT {
+    uint32_t dwSize;
+    uint32_t dwFlags;
+    uint32_t dwFourCC;
+    uint32_t dwRGBBitCount;
+    uint32_t dwRBitMask;
+    uint32_t dwGBitMask;
+    uint32_t dwBBitMask;
+    uint32_t dwABitMask;
+};
+
+struct DDS_HEADER {
+    uint32_t        dwSize;
+    uint32_t        dwFlags;
+    uint32_t        dwHeight;
+    uint32_t        dwWidth;
+    uint32_t        dwPitchOrLinearSize;
+    uint32_t        dwDepth;
+    uint32_t        dwMipMapCount;
+    uint32_t        dwReserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t        dwCaps;
+    uint32_t        dwCaps2;
+    uint32_t        dwCaps3;
+    uint32_t        dwCaps4;
+    uint32_t        dwReserved2;
+};
+
+// Форматы, которые умеет читать LoadDDS
+enum class TexelFormat : uint8_t {
+    Unknown,
+    BC1,
+    BC2,
+    BC3,
+    BGRA8,
+};
+
+bool IsBlockCompressed(TexelFormat fmt);
+uint32_t GetBlockBytes(TexelFormat fmt);
+
+// Размер одного мипа в байтах и шаг строки (строка блоков для BC)
+void GetSurfaceInfo(TexelFormat fmt, uint32_t width, uint32_t height, uint32_t& rowPitch, uint32_t& rowCount);
+size_t GetSurfaceSize(TexelFormat fmt, uint32_t width, uint32_t height);
+
+// Смещение мипа в данных DDS: массив граней, в каждой цепочка мипов
+size_t GetSubresourceOffset(TexelFormat fmt, uint32_t width, uint32_t height, uint32_t mipCount,
+    uint32_t arraySlice, uint32_t mip);
+
+// Содержимое DDS после заголовка: грани подряд, в каждой цепочка мипов
+struct DDSImage {
+    TexelFormat fmt = TexelFormat::Unknown;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 1;
+    bool isCubemap = false;
+    std::vector<uint8_t> data;
+};
+
+// Переносимый аналог LoadDDS из приложения, проверяет размер данных
+bool LoadDDSFile(const std::filesystem::path& path, DDSImage& image);
+
+// Запись в раскладке, которую читает LoadDDS: грани подряд, в каждой цепочка мипов.
+// reserved - необязательные 11 слов для dwReserved1
+bool SaveDDS(const std::filesystem::path& path, TexelFormat fmt, uint32_t width, uint32_t height,
+    uint32_t mipCount, bool isCubemap, const void* data, size_t dataSize, const uint32_t* reserved = nullptr);
+
+// Распаковка блока 4x4 в RGBA8
+void DecodeBC1Block(const uint8_t* block, uint8_t rgba[16][4]);
+void DecodeBC2Block(const uint8_t* block, uint8_t rgba[16][4]);
+void DecodeBC3Block(const uint8_t* block, uint8_t rgba[16][4]);
+
+// Распаковка мипа в RGBA float [0, 1], width * height * 4 значений
+bool DecodeSurface(TexelFormat fmt, const void* data, uint32_t width, uint32_t height, std::vector<float>& rgba);
+
+// Грани кубической карты в порядке D3D: +X, -X, +Y, -Y, +Z, -Z
+struct CubemapImage {
+    uint32_t size = 0;
+    std::vector<float> faces[6];
+};
+
+bool DecodeCubemap(TexelFormat fmt, const void* data, uint32_t width, uint32_t height, uint32_t mipCount,
+    uint32_t mip, CubemapImage& out);
+
+// Направление (не нормализованное) для координат u, v в [-1, 1] на грани face
+void CubemapTexelDirection(int face, float u, float v, float dir[3]);
+
+// Обратное преобразование: грань и координаты u, v в [-1, 1]
+int CubemapDirectionToFace(const float dir[3], float& u, float& v);
@@ -0,0 +1,363 @@
+#include "TexturePacker.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace {
+
+struct SkylineNode {
+    uint32_t x, y, width;
+};
+
+// Упаковка в ячейках выравнивания
+class Skyline {
+public:
+    Skyline(uint32_t width, uint32_t height) : m_width(width), m_height(height) {
+        m_nodes.push_back({ 0, 0, width });
+    }
+
+    bool Insert(uint32_t width, uint32_t height, uint32_t& outX, uint32_t& outY) {
+        size_t bestIndex = SIZE_MAX;
+        uint32_t bestY = UINT32_MAX;
+        uint32_t bestX = 0;
+
+        for (size_t i = 0; i < m_nodes.size(); ++i) {
+            uint32_t y = 0;
+            if (!Fits(i, width, height, y)) continue;
+            if (y < bestY || (y == bestY && m_nodes[i].x < bestX)) {
+                bestIndex = i;
+                bestY = y;
+                bestX = m_nodes[i].x;
+            }
+        }
+        if (bestIndex == SIZE_MAX) return false;
+
+        outX = bestX;
+        outY = bestY;
+        AddLevel(bestIndex, bestX, bestY + height, width);
+        return true;
+    }
+
+private:
+    bool Fits(size_t index, uint32_t width, uint32_t height, uint32_t& y) const {
+        uint32_t x = m_nodes[index].x;
+        if (x + width > m_width) return false;
+
+        y = 0;
+        uint32_t remaining = width;
+        for (size_t i = index; remaining > 0; ++i) {
+            if (i >= m_nodes.size()) return false;
+            y = std::max(y, m_nodes[i].y);
+            if (y + height > m_height) return false;
+            remaining -= std::min(remaining, m_nodes[i].width);
+        }
+        return true;
+    }
+
+    void AddLevel(size_t index, uint32_t x, uint32_t y, uint32_t width) {
+        m_nodes.insert(m_nodes.begin() + index, { x, y, width });
+
+        // Срезаем узлы, перекрытые новым
+        for (size_t i = index + 1; i < m_nodes.size();) {
+            SkylineNode& prev = m_nodes[i - 1];
+            SkylineNode& node = m_nodes[i];
+            if (node.x >= prev.x + prev.width) break;
+            uint32_t shrink = prev.x + prev.width - node.x;
+            if (shrink >= node.width) {
+                m_nodes.erase(m_nodes.begin() + i);
+                continue;
+            }
+            node.x += shrink;
+            node.width -= shrink;
+            break;
+        }
+
+        // Склеиваем соседей одной высоты
+        for (size_t i = 0; i + 1 < m_nodes.size();) {
+            if (m_nodes[i].y == m_nodes[i + 1].y) {
+                m_nodes[i].width += m_nodes[i + 1].width;
+                m_nodes.erase(m_nodes.begin() + i + 1);
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+
+    uint32_t m_width;
+    uint32_t m_height;
+    std::vector<SkylineNode> m_nodes;
+};
+
+uint32_t GetBlockDim(TexelFormat fmt) {
+    return IsBlockCompressed(fmt) ? 4 : 1;
+}
+
+// Ячеек на сторону с полем. Поле перед текстурой - всегда ячейка: начало выровнено по ней.
+// Поле после не нужно, если остаток последней ячейки уже даёт хотя бы тексель повтора на каждом мипе.
+uint32_t CellsWithGutter(uint32_t size, uint32_t cellTexels, uint32_t mipCount) {
+    uint32_t cells = (size + cellTexels - 1) / cellTexels;
+    bool trailing = false;
+    for (uint32_t mip = 0; mip < mipCount; ++mip) {
+        trailing = trailing || ((cells * cellTexels) >> mip) <= std::max(1u, size >> mip);
+    }
+    return cells + (trailing ? 2 : 1);
+}
+
+struct Placement {
+    uint32_t texture;
+    uint32_t page;
+    uint32_t cellX, cellY;     // левый верхний угол с полем
+    uint32_t cellsW, cellsH;   // размер с полем
+};
+
+// Тексель (x, y) блока берётся из (mapX[x], mapY[y]) исходного блока
+struct BlockMap {
+    uint32_t source;
+    uint8_t map[4];
+    bool identity;
+};
+
+// Блок rel относительно текстуры: поле до неё повторяет первый тексель, поле после - последний,
+// в неполном последнем блоке тексели за краем заменяются краевым
+BlockMap MakeBlockMap(int64_t rel, uint32_t blockCount, uint32_t lastTexel) {
+    BlockMap m;
+    m.source = static_cast<uint32_t>(std::clamp<int64_t>(rel, 0, blockCount - 1));
+    for (uint8_t i = 0; i < 4; ++i) {
+        if (rel < 0) m.map[i] = 0;
+        else if (rel >= blockCount) m.map[i] = static_cast<uint8_t>(lastTexel);
+        else if (rel == blockCount - 1) m.map[i] = static_cast<uint8_t>(std::min<uint32_t>(i, lastTexel));
+        else m.map[i] = i;
+    }
+    m.identity = m.map[0] == 0 && m.map[1] == 1 && m.map[2] == 2 && m.map[3] == 3;
+    return m;
+}
+
+uint64_t ReadBits(const uint8_t* p, size_t bytes) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < bytes; ++i) bits |= static_cast<uint64_t>(p[i]) << (i * 8);
+    return bits;
+}
+
+void WriteBits(uint8_t* p, size_t bytes, uint64_t bits) {
+    for (size_t i = 0; i < bytes; ++i) p[i] = static_cast<uint8_t>(bits >> (i * 8));
+}
+
+// Переставляет поле индексов длиной bitsPerTexel на тексель, 16 текселей построчно
+void RemapIndices(uint8_t* dst, const uint8_t* src, size_t bytes, uint32_t bitsPerTexel, const uint8_t mapX[4], const uint8_t mapY[4]) {
+    uint64_t in = ReadBits(src, bytes);
+    uint64_t mask = (1ull << bitsPerTexel) - 1;
+    uint64_t out = 0;
+    for (uint32_t y = 0; y < 4; ++y) {
+        for (uint32_t x = 0; x < 4; ++x) {
+            uint32_t from = mapY[y] * 4 + mapX[x];
+            out |= ((in >> (from * bitsPerTexel)) & mask) << ((y * 4 + x) * bitsPerTexel);
+        }
+    }
+    WriteBits(dst, bytes, out);
+}
+
+// BC-блок с повтором краевых текселей без перекодирования: конечные точки те же, переставляются индексы
+void RemapBlock(TexelFormat fmt, const uint8_t* src, const uint8_t mapX[4], const uint8_t mapY[4], uint8_t* dst) {
+    memcpy(dst, src, GetBlockBytes(fmt));
+    size_t colorOffset = fmt == TexelFormat::BC1 ? 0 : 8;
+    RemapIndices(dst + colorOffset + 4, src + colorOffset + 4, 4, 2, mapX, mapY);
+    if (fmt == TexelFormat::BC2) {
+        RemapIndices(dst, src, 8, 4, mapX, mapY);
+    }
+    else if (fmt == TexelFormat::BC3) {
+        RemapIndices(dst + 2, src + 2, 6, 3, mapX, mapY);
+    }
+}
+
+// Копирует мип текстуры в страницу, поле заполняется повтором краевых текселей (clamp)
+void CopyToPage(const PackerTexture& tex, const Placement& place, uint32_t cellTexels, AtlasPage& page) {
+    uint32_t blockDim = GetBlockDim(page.fmt);
+    uint32_t blockBytes = GetBlockBytes(page.fmt);
+    bool compressed = IsBlockCompressed(page.fmt);
+
+    for (uint32_t mip = 0; mip < page.mipCount; ++mip) {
+        uint32_t pageRowPitch = 0, pageRows = 0;
+        GetSurfaceInfo(page.fmt, std::max(1u, page.width >> mip), std::max(1u, page.height >> mip), pageRowPitch, pageRows);
+        uint8_t* dst = page.data.data() + GetSubresourceOffset(page.fmt, page.width, page.height, page.mipCount, 0, mip);
+
+        uint32_t srcW = std::max(1u, tex.width >> mip);
+        uint32_t srcH = std::max(1u, tex.height >> mip);
+        uint32_t srcRowPitch = 0, srcRows = 0;
+        GetSurfaceInfo(tex.fmt, srcW, srcH, srcRowPitch, srcRows);
+        uint32_t srcBlocksX = srcRowPitch / blockBytes;
+        const uint8_t* src = static_cast<const uint8_t*>(tex.pData) + GetSubresourceOffset(tex.fmt, tex.width, tex.height, tex.mipCount, 0, mip);
+
+        // Ячейка на этом мипе в блоках
+        uint32_t cellBlocks = (cellTexels >> mip) / blockDim;
+        uint32_t x0 = place.cellX * cellBlocks;
+        uint32_t y0 = place.cellY * cellBlocks;
+        uint32_t w = place.cellsW * cellBlocks;
+        uint32_t h = place.cellsH * cellBlocks;
+
+        std::vector<BlockMap> columns(w);
+        for (uint32_t bx = 0; bx < w; ++bx) {
+            columns[bx] = MakeBlockMap((int64_t)bx - cellBlocks, srcBlocksX, (srcW - 1) % blockDim);
+        }
+
+        for (uint32_t by = 0; by < h; ++by) {
+            BlockMap row = MakeBlockMap((int64_t)by - cellBlocks, srcRows, (srcH - 1) % blockDim);
+            uint8_t* dstRow = dst + (size_t)(y0 + by) * pageRowPitch + (size_t)x0 * blockBytes;
+            const uint8_t* srcRow = src + (size_t)row.source * srcRowPitch;
+
+            for (uint32_t bx = 0; bx < w; ++bx) {
+                const BlockMap& column = columns[bx];
+                const uint8_t* block = srcRow + (size_t)column.source * blockBytes;
+                if (!compressed || (row.identity && column.identity)) {
+                    memcpy(dstRow + (size_t)bx * blockBytes, block, blockBytes);
+                }
+                else {
+                    RemapBlock(page.fmt, block, column.map, row.map, dstRow + (size_t)bx * blockBytes);
+                }
+            }
+        }
+    }
+}
+
+}
+
+bool PackAtlas(const std::vector<PackerTexture>& textures, const AtlasSettings& settings,
+    std::vector<AtlasPage>& pages, std::vector<AtlasEntry>& entries, AtlasStats* stats) {
+    pages.clear();
+    entries.assign(textures.size(), AtlasEntry());
+    if (textures.empty()) return true;
+
+    TexelFormat fmt = textures[0].fmt;
+    uint32_t mipCount = std::max(1u, settings.maxMips);
+    for (const PackerTexture& tex : textures) {
+        if (tex.fmt != fmt || GetBlockBytes(fmt) == 0) return false;
+        mipCount = std::min(mipCount, tex.mipCount);
+    }
+
+    // Ячейка: блок на последнем мипе атласа
+    uint32_t cellTexels = GetBlockDim(fmt) << (mipCount - 1);
+    uint32_t maxCells = settings.maxPageSize / cellTexels;
+
+    std::vector<Placement> placements(textures.size());
+    for (uint32_t i = 0; i < textures.size(); ++i) {
+        placements[i].texture = i;
+        placements[i].cellsW = CellsWithGutter(textures[i].width, cellTexels, mipCount);
+        placements[i].cellsH = CellsWithGutter(textures[i].height, cellTexels, mipCount);
+        if (placements[i].cellsW > maxCells || placements[i].cellsH > maxCells) return false;
+    }
+
+    std::vector<uint32_t> order(textures.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (placements[a].cellsH != placements[b].cellsH) return placements[a].cellsH > placements[b].cellsH;
+        return placements[a].cellsW > placements[b].cellsW;
+    });
+
+    // Начинаем с квадрата площадью в оставшиеся текстуры и растим меньшую сторону
+    // на 1/8, пока всё не влезет или не упрёмся в maxPageSize. Стороны кратны ячейке,
+    // поэтому страница не обязана быть степенью двойки.
+    struct PageCells {
+        uint32_t w, h;
+    };
+    std::vector<PageCells> pageCells;
+    size_t next = 0;
+    while (next < order.size()) {
+        uint64_t remainingCells = 0;
+        uint32_t widest = 0;
+        uint32_t tallest = 0;
+        for (size_t i = next; i < order.size(); ++i) {
+            const Placement& p = placements[order[i]];
+            remainingCells += (uint64_t)p.cellsW * p.cellsH;
+            widest = std::max(widest, p.cellsW);
+            tallest = std::max(tallest, p.cellsH);
+        }
+        uint32_t side = static_cast<uint32_t>(ceil(sqrt((double)remainingCells)));
+        PageCells cells = { std::min(std::max(side, widest), maxCells), std::min(std::max(side, tallest), maxCells) };
+
+        for (;;) {
+            Skyline skyline(cells.w, cells.h);
+            size_t placed = next;
+            while (placed < order.size()) {
+                Placement& p = placements[order[placed]];
+                if (!skyline.Insert(p.cellsW, p.cellsH, p.cellX, p.cellY)) break;
+                p.page = static_cast<uint32_t>(pageCells.size());
+                ++placed;
+            }
+            bool canGrow = cells.w < maxCells || cells.h < maxCells;
+            if (placed == order.size() || !canGrow) {
+                if (placed == next) return false;
+                next = placed;
+                break;
+            }
+            uint32_t& grow = (cells.w <= cells.h && cells.w < maxCells) || cells.h >= maxCells ? cells.w : cells.h;
+            grow = std::min(grow + std::max(1u, grow / 8), maxCells);
+        }
+        pageCells.push_back(cells);
+    }
+
+    pages.resize(pageCells.size());
+    for (size_t i = 0; i < pages.size(); ++i) {
+        pages[i].fmt = fmt;
+        pages[i].width = pageCells[i].w * cellTexels;
+        pages[i].height = pageCells[i].h * cellTexels;
+        pages[i].mipCount = mipCount;
+        pages[i].data.assign(GetSubresourceOffset(fmt, pages[i].width, pages[i].height, mipCount, 1, 0), 0);
+    }
+
+    // Области текстур не пересекаются, копируем параллельно
+    ParallelFor(placements.size(), [&](size_t i) {
+        const Placement& p = placements[i];
+        CopyToPage(textures[p.texture], p, cellTexels, pages[p.page]);
+    });
+
+    for (const Placement& p : placements) {
+        const PackerTexture& tex = textures[p.texture];
+        float pageW = (float)pages[p.page].width;
+        float pageH = (float)pages[p.page].height;
+        AtlasEntry& e = entries[p.texture];
+        e.page = p.page;
+        e.uvScale[0] = tex.width / pageW;
+        e.uvScale[1] = tex.height / pageH;
+        e.uvOffset[0] = (p.cellX + 1) * cellTexels / pageW;
+        e.uvOffset[1] = (p.cellY + 1) * cellTexels / pageH;
+    }
+
+    if (stats) {
+        stats->textureArea = 0;
+        stats->pageArea = 0;
+        for (const PackerTexture& tex : textures) stats->textureArea += (uint64_t)tex.width * tex.height;
+        for (const AtlasPage& page : pages) stats->pageArea += (uint64_t)page.width * page.height;
+    }
+    return true;
+}
+
+void PackTextureArrays(const std::vector<PackerTexture>& textures, std::vector<TextureArray>& arrays,
+    std::vector<ArrayEntry>& entries) {
+    arrays.clear();
+    entries.assign(textures.size(), ArrayEntry());
+
+    for (size_t i = 0; i < textures.size(); ++i) {
+        const PackerTexture& tex = textures[i];
+        auto it = std::find_if(arrays.begin(), arrays.end(), [&](const TextureArray& a) {
+            return a.fmt == tex.fmt && a.width == tex.width && a.height == tex.height && a.mipCount == tex.mipCount;
+        });
+        if (it == arrays.end()) {
+            TextureArray a;
+            a.fmt = tex.fmt;
+            a.width = tex.width;
+            a.height = tex.height;
+            a.mipCount = tex.mipCount;
+            arrays.push_back(std::move(a));
+            it = arrays.end() - 1;
+        }
+
+        size_t sliceSize = GetSubresourceOffset(tex.fmt, tex.width, tex.height, tex.mipCount, 1, 0);
+        const uint8_t* src = static_cast<const uint8_t*>(tex.pData);
+        it->data.insert(it->data.end(), src, src + sliceSize);
+        entries[i].array = static_cast<uint32_t>(it - arrays.begin());
+        entries[i].slice = it->sliceCount++;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "TextureData.h"
+
+// 2D текстура в раскладке LoadDDS: цепочка мипов подряд
+struct PackerTexture {
+    TexelFormat fmt = TexelFormat::Unknown;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 1;
+    const void* pData = nullptr;
+};
+
+// maxMips ограничивает цепочку мипов атласа: текстуры в нём теряют мипы начиная с maxMips.
+// Это цена выравнивания: ячейка и поле вокруг каждой текстуры - 4 * 2^(maxMips-1) текселей,
+// т.е. 16 при 3 мипах, 64 при 5. Текстуры меньше ячейки при этом занимают в атласе минимум
+// 2x2 ячейки, поэтому плотность падает с ростом maxMips (для текстур 8..256 текселей примерно
+// 74% при 1 мипе, 48% при 3 и 30% при 5). Для полной цепочки мипов используйте PackTextureArrays.
+struct AtlasSettings {
+    uint32_t maxPageSize = 4096;
+    uint32_t maxMips = 3;
+};
+
+// Страница атласа, данные готовы для CreateTextureSRV / SaveDDS
+struct AtlasPage {
+    TexelFormat fmt = TexelFormat::Unknown;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 1;
+    std::vector<uint8_t> data;
+};
+
+// uv в атласе = uv * uvScale + uvOffset
+struct AtlasEntry {
+    uint32_t page = 0;
+    float uvScale[2] = { 1.0f, 1.0f };
+    float uvOffset[2] = { 0.0f, 0.0f };
+};
+
+struct AtlasStats {
+    uint64_t textureArea = 0;
+    uint64_t pageArea = 0;
+
+    double Density() const { return pageArea ? (double)textureArea / pageArea : 0.0; }
+};
+
+// Skyline bottom-left. Все текстуры одного формата, размер страниц кратен ячейке. Позиции кратны 4 * 2^(mips-1) текселей,
+// слева и сверху от каждой текстуры поле в одну такую ячейку с повтором краевых текселей (BC-блоки
+// собираются перестановкой индексов), справа и снизу - остаток последней ячейки, а если на каком-то
+// мипе он меньше текселя, то ещё ячейка. Каждый мип атласа выровнен по блокам,
+// билинейная выборка на краю работает как clamp, а соседи не протекают.
+// Число мипов страниц - min(maxMips, мипы самой короткой цепочки), см. AtlasPage::mipCount.
+bool PackAtlas(const std::vector<PackerTexture>& textures, const AtlasSettings& settings,
+    std::vector<AtlasPage>& pages, std::vector<AtlasEntry>& entries, AtlasStats* stats = nullptr);
+
+struct TextureArray {
+    TexelFormat fmt = TexelFormat::Unknown;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t mipCount = 1;
+    uint32_t sliceCount = 0;
+    std::vector<uint8_t> data;
+};
+
+struct ArrayEntry {
+    uint32_t array = 0;
+    uint32_t slice = 0;
+};
+
+// Группирует текстуры с одинаковыми форматом, размером и числом мипов в массивы
+void PackTextureArrays(const std::vector<PackerTexture>& textures, std::vector<TextureArray>& arrays,
+    std::vector<ArrayEntry>& entries);
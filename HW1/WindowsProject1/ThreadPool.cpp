@@ -0,0 +1,117 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (std::thread& t : m_threads) {
+        t.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+            if (m_stop && m_tasks.empty()) return;
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+ThreadPool& GetThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+namespace {
+
+thread_local bool t_serial = false;
+
+struct ParallelForState {
+    std::atomic<size_t> next{ 0 };
+    std::atomic<size_t> done{ 0 };
+    size_t count = 0;
+    const std::function<void(size_t)>* fn = nullptr;
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // Возвращает false, когда работы не осталось
+    bool RunOne() {
+        size_t i = next.fetch_add(1);
+        if (i >= count) return false;
+        (*fn)(i);
+        if (done.fetch_add(1) + 1 == count) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        }
+        return true;
+    }
+};
+
+}
+
+SerialScope::SerialScope() : m_previous(t_serial) {
+    t_serial = true;
+}
+
+SerialScope::~SerialScope() {
+    t_serial = m_previous;
+}
+
+bool SerialScope::IsActive() {
+    return t_serial;
+}
+
+void ParallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (count == 1 || t_serial) {
+        for (size_t i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    // Состояние живёт, пока его держат опоздавшие задачи пула
+    auto state = std::make_shared<ParallelForState>();
+    state->count = count;
+    state->fn = &fn;
+
+    ThreadPool& pool = GetThreadPool();
+    size_t helpers = std::min(pool.GetThreadCount(), count - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        pool.Submit([state] {
+            while (state->RunOne()) {}
+        });
+    }
+
+    while (state->RunOne()) {}
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&] { return state->done.load() == count; });
+}
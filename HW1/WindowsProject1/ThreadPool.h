@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task);
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+};
+
+ThreadPool& GetThreadPool();
+
+// Пока объект жив, ParallelFor в этом потоке выполняет всю работу сам по порядку.
+// Так последовательный замер не уходит во вложенные циклы пула.
+class SerialScope {
+public:
+    SerialScope();
+    ~SerialScope();
+
+    SerialScope(const SerialScope&) = delete;
+    SerialScope& operator=(const SerialScope&) = delete;
+
+    static bool IsActive();
+
+private:
+    bool m_previous;
+};
+
+// Вызывает fn(i) для i в [0, count). Вызывающий поток тоже берёт работу,
+// поэтому вложенный вызов из задачи пула не блокируется.
+void ParallelFor(size_t count, const std::function<void(size_t)>& fn);
@@ -0,0 +1,384 @@
+#include "VertexQuantization.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+// QUANT_NO_SSE оставляет только скалярный путь, для сравнения в бенчмарке
+#if (defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)) && !defined(QUANT_NO_SSE)
+#include <emmintrin.h>
+#define QUANT_USE_SSE 1
+#endif
+
+namespace {
+
+const float Snorm16Max = 32767.0f;
+const float Unorm16Max = 65535.0f;
+
+uint32_t AsUint(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+float AsFloat(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+const float* Advance(const float* p, size_t stride, size_t i) {
+    return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(p) + i * stride);
+}
+
+uint8_t* Advance(void* p, size_t stride, size_t i) {
+    return static_cast<uint8_t*>(p) + i * stride;
+}
+
+// Округление к ближайшему чётному, как _mm_cvtps_epi32
+int16_t ToSnorm16(float v) {
+    return static_cast<int16_t>(lrintf(std::min(std::max(v, -1.0f), 1.0f) * Snorm16Max));
+}
+
+uint16_t ToUnorm16(float v) {
+    return static_cast<uint16_t>(lrintf(std::min(std::max(v, 0.0f), 1.0f) * Unorm16Max));
+}
+
+float SignNotZero(float v) {
+    return v >= 0.0f ? 1.0f : -1.0f;
+}
+
+#ifdef QUANT_USE_SSE
+
+__m128 LoadFloat3(const float* p) {
+    return _mm_set_ps(0.0f, p[2], p[1], p[0]);
+}
+
+// Та же схема, что в FloatToHalf, по 4 значения. Результат - int32 с расширенным знаком,
+// поэтому _mm_packs_epi32 даёт точные 16 бит.
+__m128i FloatToHalf4(__m128 f) {
+    const __m128i signMask = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+    const __m128i infinity = _mm_set1_epi32(0x7c00);
+    const __m128i nanBit = _mm_set1_epi32(0x200);
+
+    __m128 justSign = _mm_and_ps(f, _mm_castsi128_ps(signMask));
+    __m128 absF = _mm_xor_ps(f, justSign);
+    __m128i absInt = _mm_castps_si128(absF);
+
+    __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absF, absF));
+    __m128i isRegular = _mm_cmpgt_epi32(f16Max, absInt);
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absInt);
+    __m128i infOrNan = _mm_or_si128(_mm_and_si128(isNan, nanBit), infinity);
+
+    __m128 subnorm = _mm_add_ps(absF, _mm_castsi128_ps(subnormMagic));
+    __m128i subnormBits = _mm_sub_epi32(_mm_castps_si128(subnorm), subnormMagic);
+
+    __m128i mantOdd = _mm_srai_epi32(_mm_slli_epi32(absInt, 31 - 13), 31);
+    __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absInt, normalBias), mantOdd), 13);
+
+    __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormBits), _mm_andnot_si128(isSubnormal, normal));
+    __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infOrNan));
+    return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+}
+
+#endif
+
+}
+
+const VertexAttributeDesc& GetVertexAttributeDesc(VertexAttributeFormat format) {
+    // DXGI_FORMAT_R16G16B16A16_SNORM, R16G16B16A16_FLOAT, R16G16_UNORM, R16G16_SNORM
+    static const VertexAttributeDesc Descs[] = {
+        { 13, 8 },
+        { 10, 8 },
+        { 35, 4 },
+        { 37, 4 },
+    };
+    return Descs[static_cast<size_t>(format)];
+}
+
+uint16_t FloatToHalf(float value) {
+    uint32_t f = AsUint(value);
+    uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+
+    uint32_t o;
+    if (f >= (127u + 16u) << 23) {
+        // Переполнение в бесконечность, NaN остаётся NaN
+        o = f > (255u << 23) ? 0x7e00 : 0x7c00;
+    }
+    else if (f < (113u << 23)) {
+        // Денормализованные: выравниваем мантиссу сложением с магическим числом
+        float magic = AsFloat(((127u - 15u) + (23u - 10u) + 1u) << 23);
+        o = AsUint(AsFloat(f) + magic) - AsUint(magic);
+    }
+    else {
+        uint32_t mantOdd = (f >> 13) & 1;
+        f += 0xfffu - ((127u - 15u) << 23);
+        f += mantOdd;
+        o = f >> 13;
+    }
+    return static_cast<uint16_t>(o | (sign >> 16));
+}
+
+float HalfToFloat(uint16_t value) {
+    const uint32_t shiftedExp = 0x7c00u << 13;
+    uint32_t o = (value & 0x7fffu) << 13;
+    uint32_t exp = o & shiftedExp;
+    o += (127u - 15u) << 23;
+
+    if (exp == shiftedExp) {
+        o += (128u - 16u) << 23;
+    }
+    else if (exp == 0) {
+        o += 1u << 23;
+        o = AsUint(AsFloat(o) - AsFloat(113u << 23));
+    }
+    return AsFloat(o | ((value & 0x8000u) << 16));
+}
+
+void ComputeQuantizationBounds(const float* positions, size_t count, size_t stride, QuantizationBounds& bounds) {
+    bounds = QuantizationBounds();
+    if (count == 0) return;
+
+    float minP[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float maxP[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t i = 0; i < count; ++i) {
+        const float* p = Advance(positions, stride, i);
+        for (int k = 0; k < 3; ++k) {
+            minP[k] = std::min(minP[k], p[k]);
+            maxP[k] = std::max(maxP[k], p[k]);
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        bounds.offset[k] = 0.5f * (minP[k] + maxP[k]);
+        bounds.scale[k] = 0.5f * (maxP[k] - minP[k]);
+    }
+}
+
+void DequantizePositionSnorm16(const int16_t q[3], const QuantizationBounds& bounds, float pos[3]) {
+    for (int k = 0; k < 3; ++k) {
+        pos[k] = std::max(q[k] / Snorm16Max, -1.0f) * bounds.scale[k] + bounds.offset[k];
+    }
+}
+
+void QuantizePositionsSnorm16(const float* positions, size_t count, size_t stride,
+    const QuantizationBounds& bounds, void* out, size_t outStride) {
+    float invScale[3];
+    for (int k = 0; k < 3; ++k) {
+        invScale[k] = bounds.scale[k] > 0.0f ? 1.0f / bounds.scale[k] : 0.0f;
+    }
+
+#ifdef QUANT_USE_SSE
+    const __m128 offset = _mm_set_ps(0.0f, bounds.offset[2], bounds.offset[1], bounds.offset[0]);
+    const __m128 invScale4 = _mm_set_ps(0.0f, invScale[2], invScale[1], invScale[0]);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 maxValue = _mm_set1_ps(Snorm16Max);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m128 a = _mm_mul_ps(_mm_sub_ps(LoadFloat3(Advance(positions, stride, i)), offset), invScale4);
+        __m128 b = _mm_mul_ps(_mm_sub_ps(LoadFloat3(Advance(positions, stride, i + 1)), offset), invScale4);
+        a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(a, minusOne), one), maxValue);
+        b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(b, minusOne), one), maxValue);
+
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Advance(out, outStride, i)), packed);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Advance(out, outStride, i + 1)), _mm_srli_si128(packed, 8));
+    }
+#else
+    size_t i = 0;
+#endif
+    for (; i < count; ++i) {
+        const float* p = Advance(positions, stride, i);
+        int16_t q[4] = {};
+        for (int k = 0; k < 3; ++k) {
+            q[k] = ToSnorm16((p[k] - bounds.offset[k]) * invScale[k]);
+        }
+        memcpy(Advance(out, outStride, i), q, sizeof(q));
+    }
+}
+
+void QuantizePositionsHalf(const float* positions, size_t count, size_t stride, void* out, size_t outStride) {
+#ifdef QUANT_USE_SSE
+    // По 4 позиции в SoA: три преобразования на 4 вершины без пустых дорожек
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float* p0 = Advance(positions, stride, i);
+        const float* p1 = Advance(positions, stride, i + 1);
+        const float* p2 = Advance(positions, stride, i + 2);
+        const float* p3 = Advance(positions, stride, i + 3);
+        __m128i hx = FloatToHalf4(_mm_set_ps(p3[0], p2[0], p1[0], p0[0]));
+        __m128i hy = FloatToHalf4(_mm_set_ps(p3[1], p2[1], p1[1], p0[1]));
+        __m128i hz = FloatToHalf4(_mm_set_ps(p3[2], p2[2], p1[2], p0[2]));
+
+        // x0..x3 z0..z3 и y0..y3 0..0 -> x y z 0 по вершинам
+        __m128i xz = _mm_packs_epi32(hx, hz);
+        __m128i y0 = _mm_packs_epi32(hy, _mm_setzero_si128());
+        __m128i xy = _mm_unpacklo_epi16(xz, y0);
+        __m128i zw = _mm_unpackhi_epi16(xz, y0);
+        __m128i v01 = _mm_unpacklo_epi32(xy, zw);
+        __m128i v23 = _mm_unpackhi_epi32(xy, zw);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Advance(out, outStride, i)), v01);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Advance(out, outStride, i + 1)), _mm_srli_si128(v01, 8));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Advance(out, outStride, i + 2)), v23);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(Advance(out, outStride, i + 3)), _mm_srli_si128(v23, 8));
+    }
+#else
+    size_t i = 0;
+#endif
+    for (; i < count; ++i) {
+        const float* p = Advance(positions, stride, i);
+        uint16_t h[4] = { FloatToHalf(p[0]), FloatToHalf(p[1]), FloatToHalf(p[2]), 0 };
+        memcpy(Advance(out, outStride, i), h, sizeof(h));
+    }
+}
+
+void QuantizeTexcoordsUnorm16(const float* texcoords, size_t count, size_t stride, void* out, size_t outStride) {
+#ifdef QUANT_USE_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 maxValue = _mm_set1_ps(Unorm16Max);
+    // packus_epi32 только в SSE4.1: сдвигаем в знаковый диапазон и возвращаем после упаковки
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float* t0 = Advance(texcoords, stride, i);
+        const float* t1 = Advance(texcoords, stride, i + 1);
+        const float* t2 = Advance(texcoords, stride, i + 2);
+        const float* t3 = Advance(texcoords, stride, i + 3);
+        __m128 a = _mm_set_ps(t1[1], t1[0], t0[1], t0[0]);
+        __m128 b = _mm_set_ps(t3[1], t3[0], t2[1], t2[0]);
+        a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(a, zero), one), maxValue);
+        b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(b, zero), one), maxValue);
+
+        __m128i qa = _mm_sub_epi32(_mm_cvtps_epi32(a), bias);
+        __m128i qb = _mm_sub_epi32(_mm_cvtps_epi32(b), bias);
+        __m128i packed = _mm_xor_si128(_mm_packs_epi32(qa, qb), bias16);
+
+        for (size_t k = 0; k < 4; ++k) {
+            uint32_t uv = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+            memcpy(Advance(out, outStride, i + k), &uv, sizeof(uv));
+            packed = _mm_srli_si128(packed, 4);
+        }
+    }
+#else
+    size_t i = 0;
+#endif
+    for (; i < count; ++i) {
+        const float* t = Advance(texcoords, stride, i);
+        uint16_t q[2] = { ToUnorm16(t[0]), ToUnorm16(t[1]) };
+        memcpy(Advance(out, outStride, i), q, sizeof(q));
+    }
+}
+
+// Проекция на октаэдр |x| + |y| + |z| = 1, нижняя половина отворачивается наружу квадрата
+void EncodeOctahedral(const float n[3], int16_t out[2]) {
+    float invL1 = 1.0f / (fabsf(n[0]) + fabsf(n[1]) + fabsf(n[2]));
+    float x = n[0] * invL1;
+    float y = n[1] * invL1;
+    if (n[2] < 0.0f) {
+        float fx = (1.0f - fabsf(y)) * SignNotZero(x);
+        float fy = (1.0f - fabsf(x)) * SignNotZero(y);
+        x = fx;
+        y = fy;
+    }
+    out[0] = ToSnorm16(x);
+    out[1] = ToSnorm16(y);
+}
+
+void DecodeOctahedral(const int16_t enc[2], float n[3]) {
+    float x = std::max(enc[0] / Snorm16Max, -1.0f);
+    float y = std::max(enc[1] / Snorm16Max, -1.0f);
+    float z = 1.0f - fabsf(x) - fabsf(y);
+    if (z < 0.0f) {
+        float fx = (1.0f - fabsf(y)) * SignNotZero(x);
+        float fy = (1.0f - fabsf(x)) * SignNotZero(y);
+        x = fx;
+        y = fy;
+    }
+    float invLen = 1.0f / sqrtf(x * x + y * y + z * z);
+    n[0] = x * invLen;
+    n[1] = y * invLen;
+    n[2] = z * invLen;
+}
+
+void QuantizeNormalsOctahedral(const float* normals, size_t count, size_t stride, void* out, size_t outStride) {
+#ifdef QUANT_USE_SSE
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 minusOne = _mm_set1_ps(-1.0f);
+    const __m128 maxValue = _mm_set1_ps(Snorm16Max);
+
+    // По 4 нормали в SoA
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float* n0 = Advance(normals, stride, i);
+        const float* n1 = Advance(normals, stride, i + 1);
+        const float* n2 = Advance(normals, stride, i + 2);
+        const float* n3 = Advance(normals, stride, i + 3);
+        __m128 x = _mm_set_ps(n3[0], n2[0], n1[0], n0[0]);
+        __m128 y = _mm_set_ps(n3[1], n2[1], n1[1], n0[1]);
+        __m128 z = _mm_set_ps(n3[2], n2[2], n1[2], n0[2]);
+
+        __m128 absX = _mm_andnot_ps(signMask, x);
+        __m128 absY = _mm_andnot_ps(signMask, y);
+        __m128 absZ = _mm_andnot_ps(signMask, z);
+        __m128 invL1 = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(absX, absY), absZ));
+        x = _mm_mul_ps(x, invL1);
+        y = _mm_mul_ps(y, invL1);
+
+        // SignNotZero через сравнение, чтобы -0 давал 1, как в скалярной версии
+        __m128 signX = _mm_or_ps(one, _mm_andnot_ps(_mm_cmpge_ps(x, zero), signMask));
+        __m128 signY = _mm_or_ps(one, _mm_andnot_ps(_mm_cmpge_ps(y, zero), signMask));
+        __m128 foldX = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, y)), signX);
+        __m128 foldY = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), signY);
+
+        __m128 lower = _mm_cmplt_ps(z, zero);
+        x = _mm_or_ps(_mm_and_ps(lower, foldX), _mm_andnot_ps(lower, x));
+        y = _mm_or_ps(_mm_and_ps(lower, foldY), _mm_andnot_ps(lower, y));
+
+        x = _mm_mul_ps(_mm_min_ps(_mm_max_ps(x, minusOne), one), maxValue);
+        y = _mm_mul_ps(_mm_min_ps(_mm_max_ps(y, minusOne), one), maxValue);
+
+        // x0 y0 x1 y1 | x2 y2 x3 y3
+        __m128i qx = _mm_cvtps_epi32(x);
+        __m128i qy = _mm_cvtps_epi32(y);
+        __m128i packed = _mm_packs_epi32(_mm_unpacklo_epi32(qx, qy), _mm_unpackhi_epi32(qx, qy));
+
+        for (size_t k = 0; k < 4; ++k) {
+            uint32_t xy = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+            memcpy(Advance(out, outStride, i + k), &xy, sizeof(xy));
+            packed = _mm_srli_si128(packed, 4);
+        }
+    }
+#else
+    size_t i = 0;
+#endif
+    for (; i < count; ++i) {
+        int16_t q[2];
+        EncodeOctahedral(Advance(normals, stride, i), q);
+        memcpy(Advance(out, outStride, i), q, sizeof(q));
+    }
+}
+
+void GetQuantizationErrorBounds(const QuantizationBounds& bounds, QuantizationErrorBounds& out) {
+    // Половина шага сетки плюс ошибка float при переводе в сетку и обратно
+    for (int k = 0; k < 3; ++k) {
+        out.positionSnorm16[k] = bounds.scale[k] * (0.5f + Snorm16Max * 4.0f * FLT_EPSILON) / Snorm16Max
+            + fabsf(bounds.offset[k]) * FLT_EPSILON;
+    }
+    out.positionHalfRelative = 1.0f / 2048.0f;
+    out.texcoordUnorm16 = (0.5f + Unorm16Max * 2.0f * FLT_EPSILON) / Unorm16Max;
+    // Полшага по каждой оси, развёртка октаэдра растягивает расстояния не больше чем в 4 раза
+    out.normalOctahedralRadians = 4.0f * sqrtf(2.0f) * (0.5f / Snorm16Max);
+}
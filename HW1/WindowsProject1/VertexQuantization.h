@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Сжатые атрибуты вершин. Форматы совпадают с DXGI:
+//   позиция snorm16   - R16G16B16A16_SNORM, 8 байт, относительно AABB меша
+//   позиция half      - R16G16B16A16_FLOAT, 8 байт, без масштаба
+//   uv unorm16        - R16G16_UNORM, 4 байта, uv в [0, 1]
+//   нормаль octahedral - R16G16_SNORM, 4 байта
+// Все Quantize* принимают float-данные с шагом stride байт и пишут с шагом outStride,
+// поэтому можно кодировать сразу в чередующийся вершинный буфер.
+
+// Описание формата для входной раскладки. dxgiFormat - значение DXGI_FORMAT,
+// size - сколько байт пишет Quantize* на вершину.
+enum class VertexAttributeFormat : uint8_t {
+    PositionSnorm16,
+    PositionHalf,
+    TexcoordUnorm16,
+    NormalOctahedral,
+};
+
+struct VertexAttributeDesc {
+    uint32_t dxgiFormat;
+    uint32_t size;
+};
+
+const VertexAttributeDesc& GetVertexAttributeDesc(VertexAttributeFormat format);
+
+// pos = q * scale + offset, q в [-1, 1] после выборки snorm в шейдере
+struct QuantizationBounds {
+    float scale[3] = { 1.0f, 1.0f, 1.0f };
+    float offset[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+void ComputeQuantizationBounds(const float* positions, size_t count, size_t stride, QuantizationBounds& bounds);
+
+void QuantizePositionsSnorm16(const float* positions, size_t count, size_t stride,
+    const QuantizationBounds& bounds, void* out, size_t outStride);
+void QuantizePositionsHalf(const float* positions, size_t count, size_t stride, void* out, size_t outStride);
+void QuantizeTexcoordsUnorm16(const float* texcoords, size_t count, size_t stride, void* out, size_t outStride);
+// Нормали должны быть единичными
+void QuantizeNormalsOctahedral(const float* normals, size_t count, size_t stride, void* out, size_t outStride);
+
+// Скалярные преобразования, так же их выполняет выборка вершин
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+void DequantizePositionSnorm16(const int16_t q[3], const QuantizationBounds& bounds, float pos[3]);
+void EncodeOctahedral(const float n[3], int16_t out[2]);
+void DecodeOctahedral(const int16_t enc[2], float n[3]);
+
+// Оценки ошибки: абсолютная по осям для snorm16, относительная для half,
+// абсолютная для uv и угловая (радианы) для нормалей
+struct QuantizationErrorBounds {
+    float positionSnorm16[3];
+    float positionHalfRelative;
+    float texcoordUnorm16;
+    float normalOctahedralRadians;
+};
+
+void GetQuantizationErrorBounds(const QuantizationBounds& bounds, QuantizationErrorBounds& out);
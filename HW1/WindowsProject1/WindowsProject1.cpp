@@ -5,6 +5,7 @@
 #include <d3dcompiler.h>
 #include <assert.h>
 #include <tchar.h>
+#include <stdio.h>
 #include <DirectXMath.h>
 #include <vector>
 #include <string>
@@ -12,6 +13,8 @@
 #include <iostream>
 #include <algorithm>
 
+#include "SceneStartup.h"
+
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
 #pragma comment(lib, "d3dcompiler.lib")
@@ -19,7 +22,6 @@
 using namespace DirectX;
 
 #define SAFE_RELEASE(p) { if (p) { (p)->Release(); (p) = nullptr; } }
-#define DDS_MAGIC 0x20534444 
 
 
 ID3D11Device* m_pDevice = nullptr;
@@ -35,6 +37,9 @@ ID3D11VertexShader* m_pCubeVS = nullptr;
 ID3D11PixelShader* m_pCubePS = nullptr;
 ID3D11InputLayout* m_pCubeLayout = nullptr;
 ID3D11ShaderResourceView* m_pCubeTextureView = nullptr;
+UINT m_cubeIndexCount = 0;
+DXGI_FORMAT m_cubeIndexFormat = DXGI_FORMAT_R16_UINT;
+QuantizationBounds m_cubeBounds;
 
 
 ID3D11Buffer* m_pSkyboxVB = nullptr;
@@ -43,7 +48,10 @@ ID3D11VertexShader* m_pSkyboxVS = nullptr;
 ID3D11PixelShader* m_pSkyboxPS = nullptr;
 ID3D11InputLayout* m_pSkyboxLayout = nullptr;
 ID3D11ShaderResourceView* m_pSkyboxView = nullptr;
+ID3D11ShaderResourceView* m_pSkyboxSpecularView = nullptr;
 UINT m_skyboxIndexCount = 0;
+DXGI_FORMAT m_skyboxIndexFormat = DXGI_FORMAT_R16_UINT;
+QuantizationBounds m_skyboxBounds;
 ID3D11RasterizerState* m_pRasterizerStateSkybox = nullptr;
 
 
@@ -51,6 +59,13 @@ ID3D11Buffer* m_pGeomBuffer = nullptr;
 ID3D11Buffer* m_pSceneBuffer = nullptr;
 ID3D11SamplerState* m_pSampler = nullptr;
 
+// Фоновое освещение от skybox, см. PackIrradianceSH. Пока его нет - равномерный белый свет,
+// куб выглядит как без освещения.
+float m_ambientSH[9][4] = { { 1.0f, 1.0f, 1.0f, 0.0f } };
+
+// Шероховатость куба, по ней выбирается мип m_pSkyboxSpecularView
+const float CubeRoughness = 0.35f;
+
 
 UINT m_width = 1280;
 UINT m_height = 720;
@@ -66,110 +81,79 @@ float camPitch = 0.0f;
 struct TextureVertex {
     float x, y, z;
     float u, v;
+    float nx, ny, nz;
 };
 
-struct SkyboxVertex {
-    float x, y, z;
-};
-
-struct GeomBuffer {
-    XMMATRIX model;
-    XMVECTOR size; 
+// Вершины в буфере: позиция snorm16 относительно AABB меша, uv unorm16, нормаль octahedral
+struct PackedTextureVertex {
+    int16_t pos[4];
+    uint16_t uv[2];
+    int16_t normal[2];
 };
 
-struct SceneBuffer {
-    XMMATRIX vp;
-    XMVECTOR cameraPos;
+struct PackedSkyboxVertex {
+    int16_t pos[4];
 };
 
-struct TextureDesc {
-    UINT32 pitch = 0;
-    UINT32 mipmapsCount = 0;
-    DXGI_FORMAT fmt = DXGI_FORMAT_UNKNOWN;
-    UINT32 width = 0;
-    UINT32 height = 0;
-    void* pData = nullptr;
+// Атрибуты вершинного буфера по порядку, форматы и размеры берутся из VertexQuantization
+struct VertexElement {
+    const char* semantic;
+    VertexAttributeFormat format;
 };
 
-struct DDS_PIXELFORMAT {
-    uint32_t dwSize;
-    uint32_t dwFlags;
-    uint32_t dwFourCC;
-    uint32_t dwRGBBitCount;
-    uint32_t dwRBitMask;
-    uint32_t dwGBitMask;
-    uint32_t dwBBitMask;
-    uint32_t dwABitMask;
+static const VertexElement CubeElements[] = {
+    { "POSITION", VertexAttributeFormat::PositionSnorm16 },
+    { "TEXCOORD", VertexAttributeFormat::TexcoordUnorm16 },
+    { "NORMAL", VertexAttributeFormat::NormalOctahedral },
 };
 
-struct DDS_HEADER {
-    uint32_t        dwSize;
-    uint32_t        dwFlags;
-    uint32_t        dwHeight;
-    uint32_t        dwWidth;
-    uint32_t        dwPitchOrLinearSize;
-    uint32_t        dwDepth;
-    uint32_t        dwMipMapCount;
-    uint32_t        dwReserved1[11];
-    DDS_PIXELFORMAT ddspf;
-    uint32_t        dwCaps;
-    uint32_t        dwCaps2;
-    uint32_t        dwCaps3;
-    uint32_t        dwCaps4;
-    uint32_t        dwReserved2;
+static const VertexElement SkyboxElements[] = {
+    { "POSITION", VertexAttributeFormat::PositionSnorm16 },
 };
 
-
-bool LoadDDS(const wchar_t* filename, TextureDesc& desc, bool isCubemap = false) {
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        OutputDebugStringA("Failed to open DDS file.\n");
-        return false;
+// Заполняет out по elements, атрибуты идут подряд в слоте 0. Возвращает шаг вершины.
+UINT MakeInputLayoutDesc(const VertexElement* elements, UINT count, D3D11_INPUT_ELEMENT_DESC* out) {
+    UINT offset = 0;
+    for (UINT i = 0; i < count; ++i) {
+        const VertexAttributeDesc& desc = GetVertexAttributeDesc(elements[i].format);
+        out[i] = { elements[i].semantic, 0, static_cast<DXGI_FORMAT>(desc.dxgiFormat), 0, offset, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+        offset += desc.size;
     }
+    return offset;
+}
 
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    uint32_t magic;
-    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
-    if (magic != DDS_MAGIC) return false;
-
-    DDS_HEADER header;
-    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+struct GeomBuffer {
+    XMMATRIX model;
+    XMVECTOR size; 
+    XMFLOAT4 posScale;
+    XMFLOAT4 posOffset;
+    XMFLOAT4 material; // x - roughness
+};
 
-    desc.width = header.dwWidth;
-    desc.height = header.dwHeight;
-    desc.mipmapsCount = header.dwMipMapCount == 0 ? 1 : header.dwMipMapCount;
+struct SceneBuffer {
+    XMMATRIX vp;
+    XMVECTOR cameraPos;
+    XMFLOAT4 ambientSH[9];
+};
 
-    
-    if (header.ddspf.dwFlags & 0x4) { 
-        switch (header.ddspf.dwFourCC) {
-        case 0x31545844: desc.fmt = DXGI_FORMAT_BC1_UNORM; break;
-        case 0x33545844: desc.fmt = DXGI_FORMAT_BC2_UNORM; break;
-        case 0x35545844: desc.fmt = DXGI_FORMAT_BC3_UNORM; break;
-        default: desc.fmt = DXGI_FORMAT_UNKNOWN; break;
-        }
-    }
-    else {
-        desc.fmt = DXGI_FORMAT_B8G8R8A8_UNORM;
+DXGI_FORMAT ToDXGIFormat(TexelFormat fmt) {
+    switch (fmt) {
+    case TexelFormat::BC1: return DXGI_FORMAT_BC1_UNORM;
+    case TexelFormat::BC2: return DXGI_FORMAT_BC2_UNORM;
+    case TexelFormat::BC3: return DXGI_FORMAT_BC3_UNORM;
+    case TexelFormat::BGRA8: return DXGI_FORMAT_B8G8R8A8_UNORM;
+    default: return DXGI_FORMAT_UNKNOWN;
     }
-
-
-    std::streamsize dataSize = size - sizeof(magic) - sizeof(header);
-    desc.pData = new char[dataSize];
-    file.read(reinterpret_cast<char*>(desc.pData), dataSize);
-
-    return true;
 }
 
 // Конвертация сырых данных в ресурс текстуры DirectX
-HRESULT CreateTextureSRV(ID3D11Device* device, const TextureDesc& desc, bool isCubemap, ID3D11ShaderResourceView** ppSRV) {
+HRESULT CreateTextureSRV(ID3D11Device* device, const DDSImage& image, bool isCubemap, ID3D11ShaderResourceView** ppSRV) {
     D3D11_TEXTURE2D_DESC texDesc = {};
-    texDesc.Width = desc.width;
-    texDesc.Height = desc.height;
-    texDesc.MipLevels = desc.mipmapsCount;
+    texDesc.Width = image.width;
+    texDesc.Height = image.height;
+    texDesc.MipLevels = image.mipCount;
     texDesc.ArraySize = isCubemap ? 6 : 1;
-    texDesc.Format = desc.fmt;
+    texDesc.Format = ToDXGIFormat(image.fmt);
     texDesc.SampleDesc.Count = 1;
     texDesc.SampleDesc.Quality = 0;
     texDesc.Usage = D3D11_USAGE_DEFAULT;
@@ -181,26 +165,14 @@ HRESULT CreateTextureSRV(ID3D11Device* device, const TextureDesc& desc, bool isC
 
     for (UINT arraySlice = 0; arraySlice < texDesc.ArraySize; ++arraySlice) {
         for (UINT mip = 0; mip < texDesc.MipLevels; ++mip) {
-            UINT mipWidth = std::max(1u, desc.width >> mip);
-            UINT mipHeight = std::max(1u, desc.height >> mip);
+            UINT mipWidth = std::max(1u, image.width >> mip);
+            UINT mipHeight = std::max(1u, image.height >> mip);
             UINT mipPitch = 0;
             UINT mipLines = 0;
-
-            if (desc.fmt == DXGI_FORMAT_BC1_UNORM) {
-                mipPitch = std::max(1u, (mipWidth + 3) / 4) * 8;
-                mipLines = std::max(1u, (mipHeight + 3) / 4);
-            }
-            else if (desc.fmt == DXGI_FORMAT_BC2_UNORM || desc.fmt == DXGI_FORMAT_BC3_UNORM) {
-                mipPitch = std::max(1u, (mipWidth + 3) / 4) * 16;
-                mipLines = std::max(1u, (mipHeight + 3) / 4);
-            }
-            else {
-                mipPitch = mipWidth * 4;
-                mipLines = mipHeight;
-            }
+            GetSurfaceInfo(image.fmt, mipWidth, mipHeight, mipPitch, mipLines);
 
             UINT index = arraySlice * texDesc.MipLevels + mip;
-            initData[index].pSysMem = static_cast<const char*>(desc.pData) + offset;
+            initData[index].pSysMem = image.data.data() + offset;
             initData[index].SysMemPitch = mipPitch;
             initData[index].SysMemSlicePitch = 0;
 
@@ -214,9 +186,16 @@ HRESULT CreateTextureSRV(ID3D11Device* device, const TextureDesc& desc, bool isC
 
     D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
     srvDesc.Format = texDesc.Format;
-    srvDesc.ViewDimension = isCubemap ? D3D11_SRV_DIMENSION_TEXTURECUBE : D3D11_SRV_DIMENSION_TEXTURE2D;
-    srvDesc.Texture2D.MostDetailedMip = 0;
-    srvDesc.Texture2D.MipLevels = texDesc.MipLevels;
+    if (isCubemap) {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+        srvDesc.TextureCube.MostDetailedMip = 0;
+        srvDesc.TextureCube.MipLevels = texDesc.MipLevels;
+    }
+    else {
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Texture2D.MostDetailedMip = 0;
+        srvDesc.Texture2D.MipLevels = texDesc.MipLevels;
+    }
 
     hr = device->CreateShaderResourceView(pTexture, &srvDesc, ppSRV);
     SAFE_RELEASE(pTexture);
@@ -228,37 +207,82 @@ const char* ShadersSource = R"(
 cbuffer GeomBuffer : register(b0) {
     float4x4 model;
     float4 size; 
+    float4 posScale;
+    float4 posOffset;
+    float4 material;
 };
 
+float3 DequantizePosition(float3 q) {
+    return q * posScale.xyz + posOffset.xyz;
+}
+
 cbuffer SceneBuffer : register(b1) {
     float4x4 vp;
     float4 cameraPos;
+    float4 ambientSH[9];
 };
 
+float3 AmbientIrradiance(float3 n) {
+    return ambientSH[0].xyz
+        + ambientSH[1].xyz * n.y + ambientSH[2].xyz * n.z + ambientSH[3].xyz * n.x
+        + ambientSH[4].xyz * (n.x * n.y) + ambientSH[5].xyz * (n.y * n.z)
+        + ambientSH[6].xyz * (3.0 * n.z * n.z - 1.0)
+        + ambientSH[7].xyz * (n.x * n.z) + ambientSH[8].xyz * (n.x * n.x - n.y * n.y);
+}
+
+// Как DecodeOctahedral в VertexQuantization, e - после выборки snorm
+float3 DecodeOctahedral(float2 e) {
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * (n.xy >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
 Texture2D colorTexture : register(t0);
 TextureCube skyboxTexture : register(t0);
+TextureCube specularTexture : register(t1);
 SamplerState colorSampler : register(s0);
 
 struct VSCubeInput {
     float3 pos : POSITION;
     float2 uv : TEXCOORD;
+    float2 normal : NORMAL;
 };
 
 struct VSCubeOutput {
     float4 pos : SV_Position;
     float2 uv : TEXCOORD;
+    float3 normal : NORMAL;
+    float3 worldPos : POSITION1;
 };
 
 VSCubeOutput vs_cube(VSCubeInput vertex) {
     VSCubeOutput result;
-    float4 worldPos = mul(model, float4(vertex.pos, 1.0));
+    float4 worldPos = mul(model, float4(DequantizePosition(vertex.pos), 1.0));
     result.pos = mul(vp, worldPos);
     result.uv = vertex.uv;
+    result.worldPos = worldPos.xyz;
+    // model без неравномерного масштаба, обратная транспонированная не нужна
+    result.normal = mul(model, float4(DecodeOctahedral(vertex.normal), 0.0)).xyz;
     return result;
 }
 
 float4 ps_cube(VSCubeOutput pixel) : SV_Target0 {
-    return float4(colorTexture.Sample(colorSampler, pixel.uv).xyz, 1.0);
+    float3 albedo = colorTexture.Sample(colorSampler, pixel.uv).xyz;
+    float3 n = normalize(pixel.normal);
+    float3 diffuse = albedo * max(AmbientIrradiance(n), 0.0);
+
+    // Мип m префильтра соответствует roughness = m / (mipCount - 1)
+    float3 v = normalize(cameraPos.xyz - pixel.worldPos);
+    uint width, height, mipCount;
+    specularTexture.GetDimensions(0, width, height, mipCount);
+    float lod = material.x * max((float)mipCount - 1.0, 0.0);
+    float3 specular = specularTexture.SampleLevel(colorSampler, reflect(-v, n), lod).xyz;
+
+    // Schlick, F0 = 0.04 для диэлектрика
+    float fresnel = 0.04 + 0.96 * pow(1.0 - saturate(dot(n, v)), 5.0);
+    return float4(lerp(diffuse, specular, fresnel), 1.0);
 }
 
 struct VSSkyboxInput {
@@ -272,9 +296,10 @@ struct VSSkyboxOutput {
 
 VSSkyboxOutput vs_skybox(VSSkyboxInput vertex) {
     VSSkyboxOutput result;
-    float3 pos = cameraPos.xyz + vertex.pos * size.x;
+    float3 localPos = DequantizePosition(vertex.pos);
+    float3 pos = cameraPos.xyz + localPos * size.x;
     result.pos = mul(vp, float4(pos, 1.0));
-    result.localPos = vertex.pos;
+    result.localPos = localPos;
     return result;
 }
 
@@ -310,53 +335,18 @@ HRESULT CreateRenderTarget() {
     return result;
 }
 
-void GenerateSphere(int latLines, int longLines, std::vector<SkyboxVertex>& vertices, std::vector<USHORT>& indices) {
-    float phiStep = XM_PI / latLines;
-    float thetaStep = 2.0f * XM_PI / longLines;
-
-    vertices.push_back({ 0.0f, 1.0f, 0.0f });
-
-    for (int i = 1; i <= latLines - 1; ++i) {
-        float phi = i * phiStep;
-        for (int j = 0; j <= longLines; ++j) {
-            float theta = j * thetaStep;
-            SkyboxVertex v;
-            v.x = sinf(phi) * cosf(theta);
-            v.y = cosf(phi);
-            v.z = sinf(phi) * sinf(theta);
-            vertices.push_back(v);
-        }
-    }
-    vertices.push_back({ 0.0f, -1.0f, 0.0f });
-
-    for (int i = 1; i <= longLines; ++i) {
-        indices.push_back(0);
-        indices.push_back(i + 1);
-        indices.push_back(i);
-    }
+DXGI_FORMAT ToDXGIFormat(IndexFormat format) {
+    return format == IndexFormat::Uint32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+}
 
-    int baseIndex = 1;
-    int ringVertexCount = longLines + 1;
-    for (int i = 0; i < latLines - 2; ++i) {
-        for (int j = 0; j < longLines; ++j) {
-            indices.push_back(baseIndex + i * ringVertexCount + j);
-            indices.push_back(baseIndex + i * ringVertexCount + j + 1);
-            indices.push_back(baseIndex + (i + 1) * ringVertexCount + j);
-
-            indices.push_back(baseIndex + (i + 1) * ringVertexCount + j);
-            indices.push_back(baseIndex + i * ringVertexCount + j + 1);
-            indices.push_back(baseIndex + (i + 1) * ringVertexCount + j + 1);
-        }
-    }
+XMFLOAT4 ToFloat4Scale(const QuantizationBounds& bounds) {
+    return XMFLOAT4(bounds.scale[0], bounds.scale[1], bounds.scale[2], 0.0f);
+}
 
-    int southPoleIndex = static_cast<int>(vertices.size()) - 1;
-    baseIndex = southPoleIndex - ringVertexCount;
-    for (int i = 0; i < longLines; ++i) {
-        indices.push_back(southPoleIndex);
-        indices.push_back(baseIndex + i);
-        indices.push_back(baseIndex + i + 1);
-    }
+XMFLOAT4 ToFloat4Offset(const QuantizationBounds& bounds) {
+    return XMFLOAT4(bounds.offset[0], bounds.offset[1], bounds.offset[2], 0.0f);
 }
+
 std::wstring GetExeDirectory() {
     wchar_t path[MAX_PATH];
     GetModuleFileNameW(nullptr, path, MAX_PATH);
@@ -378,131 +368,240 @@ std::wstring GetAssetPath(const std::wstring& filename) {
 
     return path + L"\\Assets\\" + filename;
 }
-HRESULT InitScene() {
-    HRESULT hr = S_OK;
+// Промежуточные результаты стадий старта. Стадии CPU (SceneStartup) и компиляция шейдеров
+// заполняют их, стадии создания объектов устройства забирают.
+struct StartupState {
+    ID3DBlob* shaderBlobs[4] = {};
+    SceneStartupData scene;
+};
 
+struct ShaderStage {
+    const char* entry;
+    const char* target;
+};
 
-    static const TextureVertex CubeVertices[24] = {
-        {-0.5, -0.5,  0.5, 0, 1}, { 0.5, -0.5,  0.5, 1, 1}, { 0.5, -0.5, -0.5, 1, 0}, {-0.5, -0.5, -0.5, 0, 0},
-        {-0.5,  0.5, -0.5, 0, 1}, { 0.5,  0.5, -0.5, 1, 1}, { 0.5,  0.5,  0.5, 1, 0}, {-0.5,  0.5,  0.5, 0, 0},
-        {-0.5, -0.5, -0.5, 0, 1}, { 0.5, -0.5, -0.5, 1, 1}, { 0.5,  0.5, -0.5, 1, 0}, {-0.5,  0.5, -0.5, 0, 0},
-        { 0.5, -0.5,  0.5, 0, 1}, {-0.5, -0.5,  0.5, 1, 1}, {-0.5,  0.5,  0.5, 1, 0}, { 0.5,  0.5,  0.5, 0, 0},
-        {-0.5, -0.5,  0.5, 0, 1}, {-0.5, -0.5, -0.5, 1, 1}, {-0.5,  0.5, -0.5, 1, 0}, {-0.5,  0.5,  0.5, 0, 0},
-        { 0.5, -0.5, -0.5, 0, 1}, { 0.5, -0.5,  0.5, 1, 1}, { 0.5,  0.5,  0.5, 1, 0}, { 0.5,  0.5, -0.5, 0, 0}
-    };
-    static const UINT16 CubeIndices[36] = {
-        0, 2, 1, 0, 3, 2,       4, 6, 5, 4, 7, 6,       8, 10, 9, 8, 11, 10,
-        12, 14, 13, 12, 15, 14, 16, 18, 17, 16, 19, 18, 20, 22, 21, 20, 23, 22
-    };
+static const ShaderStage ShaderStages[4] = {
+    { "vs_cube", "vs_5_0" },
+    { "ps_cube", "ps_5_0" },
+    { "vs_skybox", "vs_5_0" },
+    { "ps_skybox", "ps_5_0" },
+};
 
-    D3D11_BUFFER_DESC vbDescCube = { sizeof(CubeVertices), D3D11_USAGE_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER, 0, 0, 0 };
-    D3D11_SUBRESOURCE_DATA vbDataCube = { CubeVertices, 0, 0 };
-    m_pDevice->CreateBuffer(&vbDescCube, &vbDataCube, &m_pCubeVB);
+// Компиляция ShaderStages[i] в blobs[i], задачи независимы друг от друга
+void AddShaderCompileTasks(TaskGraph& graph, ID3DBlob* blobs[4], TaskGraph::TaskId compile[4]) {
+    for (int i = 0; i < 4; ++i) {
+        compile[i] = graph.Add(ShaderStages[i].entry, [blobs, i] {
+            UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#ifdef _DEBUG
+            flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+            ID3DBlob* pErrorBlob = nullptr;
+            D3DCompile(ShadersSource, strlen(ShadersSource), nullptr, nullptr, nullptr,
+                ShaderStages[i].entry, ShaderStages[i].target, flags, 0, &blobs[i], &pErrorBlob);
+            if (pErrorBlob) {
+                OutputDebugStringA(static_cast<const char*>(pErrorBlob->GetBufferPointer()));
+                SAFE_RELEASE(pErrorBlob);
+            }
+        });
+    }
+}
 
-    D3D11_BUFFER_DESC ibDescCube = { sizeof(CubeIndices), D3D11_USAGE_IMMUTABLE, D3D11_BIND_INDEX_BUFFER, 0, 0, 0 };
-    D3D11_SUBRESOURCE_DATA ibDataCube = { CubeIndices, 0, 0 };
-    m_pDevice->CreateBuffer(&ibDescCube, &ibDataCube, &m_pCubeIB);
+// Независимые стадии идут параллельно, объекты устройства создаются после своих входных данных.
+// ID3D11Device потокобезопасен, контекст на старте не используется.
+void BuildStartupGraph(TaskGraph& graph, StartupState& state) {
+    state.scene.cubePath = GetAssetPath(L"vect.dds");
+    state.scene.skyboxPath = GetAssetPath(L"skybox.dds");
+    state.scene.specularCachePath = GetExeDirectory() + L"skybox_specular.dds";
+
+    TaskGraph::TaskId compile[4];
+    AddShaderCompileTasks(graph, state.shaderBlobs, compile);
+
+    SceneStartupTasks scene = AddSceneStartupTasks(graph, state.scene);
+
+    graph.Add("cube buffers", [] {
+        static const TextureVertex CubeVertices[24] = {
+            {-0.5, -0.5,  0.5, 0, 1,  0, -1,  0}, { 0.5, -0.5,  0.5, 1, 1,  0, -1,  0}, { 0.5, -0.5, -0.5, 1, 0,  0, -1,  0}, {-0.5, -0.5, -0.5, 0, 0,  0, -1,  0},
+            {-0.5,  0.5, -0.5, 0, 1,  0,  1,  0}, { 0.5,  0.5, -0.5, 1, 1,  0,  1,  0}, { 0.5,  0.5,  0.5, 1, 0,  0,  1,  0}, {-0.5,  0.5,  0.5, 0, 0,  0,  1,  0},
+            {-0.5, -0.5, -0.5, 0, 1,  0,  0, -1}, { 0.5, -0.5, -0.5, 1, 1,  0,  0, -1}, { 0.5,  0.5, -0.5, 1, 0,  0,  0, -1}, {-0.5,  0.5, -0.5, 0, 0,  0,  0, -1},
+            { 0.5, -0.5,  0.5, 0, 1,  0,  0,  1}, {-0.5, -0.5,  0.5, 1, 1,  0,  0,  1}, {-0.5,  0.5,  0.5, 1, 0,  0,  0,  1}, { 0.5,  0.5,  0.5, 0, 0,  0,  0,  1},
+            {-0.5, -0.5,  0.5, 0, 1, -1,  0,  0}, {-0.5, -0.5, -0.5, 1, 1, -1,  0,  0}, {-0.5,  0.5, -0.5, 1, 0, -1,  0,  0}, {-0.5,  0.5,  0.5, 0, 0, -1,  0,  0},
+            { 0.5, -0.5, -0.5, 0, 1,  1,  0,  0}, { 0.5, -0.5,  0.5, 1, 1,  1,  0,  0}, { 0.5,  0.5,  0.5, 1, 0,  1,  0,  0}, { 0.5,  0.5, -0.5, 0, 0,  1,  0,  0}
+        };
+        static const UINT32 CubeIndices[36] = {
+            0, 2, 1, 0, 3, 2,       4, 6, 5, 4, 7, 6,       8, 10, 9, 8, 11, 10,
+            12, 14, 13, 12, 15, 14, 16, 18, 17, 16, 19, 18, 20, 22, 21, 20, 23, 22
+        };
+
+        PackedTextureVertex packedVertices[_countof(CubeVertices)];
+        ComputeQuantizationBounds(&CubeVertices[0].x, _countof(CubeVertices), sizeof(TextureVertex), m_cubeBounds);
+        QuantizePositionsSnorm16(&CubeVertices[0].x, _countof(CubeVertices), sizeof(TextureVertex), m_cubeBounds,
+            packedVertices[0].pos, sizeof(PackedTextureVertex));
+        QuantizeTexcoordsUnorm16(&CubeVertices[0].u, _countof(CubeVertices), sizeof(TextureVertex),
+            packedVertices[0].uv, sizeof(PackedTextureVertex));
+        QuantizeNormalsOctahedral(&CubeVertices[0].nx, _countof(CubeVertices), sizeof(TextureVertex),
+            packedVertices[0].normal, sizeof(PackedTextureVertex));
+
+        D3D11_BUFFER_DESC vbDescCube = { sizeof(packedVertices), D3D11_USAGE_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER, 0, 0, 0 };
+        D3D11_SUBRESOURCE_DATA vbDataCube = { packedVertices, 0, 0 };
+        m_pDevice->CreateBuffer(&vbDescCube, &vbDataCube, &m_pCubeVB);
+
+        IndexData cubeIndices;
+        PackIndices(CubeIndices, _countof(CubeIndices), _countof(CubeVertices), cubeIndices);
+        m_cubeIndexCount = cubeIndices.count;
+        m_cubeIndexFormat = ToDXGIFormat(cubeIndices.format);
+
+        D3D11_BUFFER_DESC ibDescCube = { (UINT)cubeIndices.bytes.size(), D3D11_USAGE_IMMUTABLE, D3D11_BIND_INDEX_BUFFER, 0, 0, 0 };
+        D3D11_SUBRESOURCE_DATA ibDataCube = { cubeIndices.bytes.data(), 0, 0 };
+        m_pDevice->CreateBuffer(&ibDescCube, &ibDataCube, &m_pCubeIB);
+    });
 
     // Геометрия Skybox
-    std::vector<SkyboxVertex> sphereVertices;
-    std::vector<USHORT> sphereIndices;
-    GenerateSphere(20, 20, sphereVertices, sphereIndices);
-    m_skyboxIndexCount = static_cast<UINT>(sphereIndices.size());
+    graph.Add("skybox buffers", [&state] {
+        const SceneStartupData& data = state.scene;
+        m_skyboxIndexCount = data.sphereIndices.count;
+        m_skyboxIndexFormat = ToDXGIFormat(data.sphereIndices.format);
+        m_skyboxBounds = data.sphereBounds;
+
+        D3D11_BUFFER_DESC vbDescSky = { (UINT)(data.sphereVertices.size() * sizeof(int16_t)), D3D11_USAGE_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER, 0, 0, 0 };
+        D3D11_SUBRESOURCE_DATA vbDataSky = { data.sphereVertices.data(), 0, 0 };
+        m_pDevice->CreateBuffer(&vbDescSky, &vbDataSky, &m_pSkyboxVB);
+
+        D3D11_BUFFER_DESC ibDescSky = { (UINT)data.sphereIndices.bytes.size(), D3D11_USAGE_IMMUTABLE, D3D11_BIND_INDEX_BUFFER, 0, 0, 0 };
+        D3D11_SUBRESOURCE_DATA ibDataSky = { data.sphereIndices.bytes.data(), 0, 0 };
+        m_pDevice->CreateBuffer(&ibDescSky, &ibDataSky, &m_pSkyboxIB);
+    }, { scene.sphere });
+
+    // Константные буферы, sampler, rasterizer для Skybox
+    graph.Add("states and constant buffers", [] {
+        D3D11_BUFFER_DESC geomDesc = { sizeof(GeomBuffer), D3D11_USAGE_DEFAULT, D3D11_BIND_CONSTANT_BUFFER, 0, 0, 0 };
+        m_pDevice->CreateBuffer(&geomDesc, nullptr, &m_pGeomBuffer);
+
+        D3D11_BUFFER_DESC sceneDesc = { sizeof(SceneBuffer), D3D11_USAGE_DYNAMIC, D3D11_BIND_CONSTANT_BUFFER, D3D11_CPU_ACCESS_WRITE, 0, 0 };
+        m_pDevice->CreateBuffer(&sceneDesc, nullptr, &m_pSceneBuffer);
+
+        D3D11_SAMPLER_DESC sampDesc = {};
+        sampDesc.Filter = D3D11_FILTER_ANISOTROPIC;
+        sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+        sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+        sampDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+        sampDesc.MaxAnisotropy = 16;
+        sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+        sampDesc.MinLOD = -FLT_MAX;
+        sampDesc.MaxLOD = FLT_MAX;
+        m_pDevice->CreateSamplerState(&sampDesc, &m_pSampler);
+
+        D3D11_RASTERIZER_DESC rastDesc = {};
+        rastDesc.FillMode = D3D11_FILL_SOLID;
+        rastDesc.CullMode = D3D11_CULL_NONE;
+        m_pDevice->CreateRasterizerState(&rastDesc, &m_pRasterizerStateSkybox);
+    });
 
-    D3D11_BUFFER_DESC vbDescSky = { (UINT)(sphereVertices.size() * sizeof(SkyboxVertex)), D3D11_USAGE_IMMUTABLE, D3D11_BIND_VERTEX_BUFFER, 0, 0, 0 };
-    D3D11_SUBRESOURCE_DATA vbDataSky = { sphereVertices.data(), 0, 0 };
-    m_pDevice->CreateBuffer(&vbDescSky, &vbDataSky, &m_pSkyboxVB);
-
-    D3D11_BUFFER_DESC ibDescSky = { (UINT)(sphereIndices.size() * sizeof(USHORT)), D3D11_USAGE_IMMUTABLE, D3D11_BIND_INDEX_BUFFER, 0, 0, 0 };
-    D3D11_SUBRESOURCE_DATA ibDataSky = { sphereIndices.data(), 0, 0 };
-    m_pDevice->CreateBuffer(&ibDescSky, &ibDataSky, &m_pSkyboxIB);
+    // Cube
+    graph.Add("cube shaders", [&state] {
+        ID3DBlob* pVSBlob = state.shaderBlobs[0];
+        ID3DBlob* pPSBlob = state.shaderBlobs[1];
+        if (!pVSBlob || !pPSBlob) return;
+
+        m_pDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &m_pCubeVS);
+        D3D11_INPUT_ELEMENT_DESC layoutCube[_countof(CubeElements)];
+        UINT stride = MakeInputLayoutDesc(CubeElements, _countof(CubeElements), layoutCube);
+        assert(stride == sizeof(PackedTextureVertex));
+        m_pDevice->CreateInputLayout(layoutCube, _countof(layoutCube), pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &m_pCubeLayout);
+        m_pDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &m_pCubePS);
+    }, { compile[0], compile[1] });
 
-    // Константные буферы 
-    D3D11_BUFFER_DESC geomDesc = { sizeof(GeomBuffer), D3D11_USAGE_DEFAULT, D3D11_BIND_CONSTANT_BUFFER, 0, 0, 0 };
-    m_pDevice->CreateBuffer(&geomDesc, nullptr, &m_pGeomBuffer);
+    // Skybox
+    graph.Add("skybox shaders", [&state] {
+        ID3DBlob* pVSBlob = state.shaderBlobs[2];
+        ID3DBlob* pPSBlob = state.shaderBlobs[3];
+        if (!pVSBlob || !pPSBlob) return;
+
+        m_pDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &m_pSkyboxVS);
+        D3D11_INPUT_ELEMENT_DESC layoutSky[_countof(SkyboxElements)];
+        UINT stride = MakeInputLayoutDesc(SkyboxElements, _countof(SkyboxElements), layoutSky);
+        assert(stride == sizeof(PackedSkyboxVertex));
+        m_pDevice->CreateInputLayout(layoutSky, _countof(layoutSky), pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &m_pSkyboxLayout);
+        m_pDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &m_pSkyboxPS);
+    }, { compile[2], compile[3] });
+
+    graph.Add("cube texture SRV", [&state] {
+        if (state.scene.cubeLoaded) CreateTextureSRV(m_pDevice, state.scene.cubeTexture, false, &m_pCubeTextureView);
+    }, { scene.cubeTexture });
+
+    graph.Add("skybox SRV", [&state] {
+        if (state.scene.skyboxLoaded) CreateTextureSRV(m_pDevice, state.scene.skyboxTexture, true, &m_pSkyboxView);
+    }, { scene.skyboxTexture });
+
+    graph.Add("skybox specular SRV", [&state] {
+        if (state.scene.specularReady) CreateTextureSRV(m_pDevice, state.scene.specularTexture, true, &m_pSkyboxSpecularView);
+    }, { scene.specular });
+}
 
-    D3D11_BUFFER_DESC sceneDesc = { sizeof(SceneBuffer), D3D11_USAGE_DYNAMIC, D3D11_BIND_CONSTANT_BUFFER, D3D11_CPU_ACCESS_WRITE, 0, 0 };
-    m_pDevice->CreateBuffer(&sceneDesc, nullptr, &m_pSceneBuffer);
+void ReleaseStartupState(StartupState& state) {
+    for (ID3DBlob*& blob : state.shaderBlobs) {
+        SAFE_RELEASE(blob);
+    }
+}
 
-    UINT flags = D3DCOMPILE_ENABLE_STRICTNESS;
-#ifdef _DEBUG
-    flags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
-    ID3DBlob* pVSBlob = nullptr; ID3DBlob* pPSBlob = nullptr; ID3DBlob* pErrorBlob = nullptr;
+HRESULT InitScene() {
+    HRESULT hr = S_OK;
 
-    // Cube
-    D3DCompile(ShadersSource, strlen(ShadersSource), nullptr, nullptr, nullptr, "vs_cube", "vs_5_0", flags, 0, &pVSBlob, &pErrorBlob);
-    m_pDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &m_pCubeVS);
-    D3D11_INPUT_ELEMENT_DESC layoutCube[] = {
-        {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-        {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0}
-    };
-    m_pDevice->CreateInputLayout(layoutCube, 2, pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &m_pCubeLayout);
-    SAFE_RELEASE(pVSBlob);
-
-    D3DCompile(ShadersSource, strlen(ShadersSource), nullptr, nullptr, nullptr, "ps_cube", "ps_5_0", flags, 0, &pPSBlob, &pErrorBlob);
-    m_pDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &m_pCubePS);
-    SAFE_RELEASE(pPSBlob);
+    StartupState state;
+    TaskGraph graph;
+    BuildStartupGraph(graph, state);
+    graph.Run();
+    OutputDebugStringA(graph.Report().c_str());
 
-    // Skybox
-    D3DCompile(ShadersSource, strlen(ShadersSource), nullptr, nullptr, nullptr, "vs_skybox", "vs_5_0", flags, 0, &pVSBlob, &pErrorBlob);
-    m_pDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), nullptr, &m_pSkyboxVS);
-    D3D11_INPUT_ELEMENT_DESC layoutSky[] = { {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0} };
-    m_pDevice->CreateInputLayout(layoutSky, 1, pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &m_pSkyboxLayout);
-    SAFE_RELEASE(pVSBlob);
-
-    D3DCompile(ShadersSource, strlen(ShadersSource), nullptr, nullptr, nullptr, "ps_skybox", "ps_5_0", flags, 0, &pPSBlob, &pErrorBlob);
-    m_pDevice->CreatePixelShader(pPSBlob->GetBufferPointer(), pPSBlob->GetBufferSize(), nullptr, &m_pSkyboxPS);
-    SAFE_RELEASE(pPSBlob);
-
-    // --- 5. Sampler State ---
-    D3D11_SAMPLER_DESC sampDesc = {};
-    sampDesc.Filter = D3D11_FILTER_ANISOTROPIC;
-    sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-    sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-    sampDesc.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-    sampDesc.MaxAnisotropy = 16;
-    sampDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
-    sampDesc.MinLOD = -FLT_MAX;
-    sampDesc.MaxLOD = FLT_MAX;
-    m_pDevice->CreateSamplerState(&sampDesc, &m_pSampler);
-
-    // Rasterizer для Skybox
-    D3D11_RASTERIZER_DESC rastDesc = {};
-    rastDesc.FillMode = D3D11_FILL_SOLID;
-    rastDesc.CullMode = D3D11_CULL_NONE;
-    m_pDevice->CreateRasterizerState(&rastDesc, &m_pRasterizerStateSkybox);
-
-
-
-    TextureDesc cubeDesc;
-    std::wstring cubePath = GetAssetPath(L"vect.dds");
-    if (LoadDDS(cubePath.c_str(), cubeDesc, false)) {
-        CreateTextureSRV(m_pDevice, cubeDesc, false, &m_pCubeTextureView);
-        delete[] static_cast<char*>(cubeDesc.pData);
+    const SceneStartupData& scene = state.scene;
+    if (scene.ambientReady) {
+        memcpy(m_ambientSH, scene.ambientSH, sizeof(m_ambientSH));
     }
-    else {
-        std::wstring errorMsg = L"Failed to load: " + cubePath;
-        MessageBoxW(nullptr, errorMsg.c_str(), L"Resource Error", MB_OK | MB_ICONERROR);
+    else if (scene.skyboxLoaded) {
+        OutputDebugStringA("Failed to decode skybox for ambient SH.\n");
+    }
+    if (scene.specularReady && !scene.specularFromCache) {
+        char msg[128];
+        sprintf_s(msg, "Specular prefilter: %.1f ms, %llu samples\n",
+            scene.specularStats.milliseconds, (unsigned long long)scene.specularStats.samples);
+        OutputDebugStringA(msg);
+        if (!scene.specularCacheSaved) OutputDebugStringA("Failed to save prefiltered cubemap.\n");
     }
 
-
-
-    TextureDesc skyboxDesc;
-    std::wstring skyboxPath = GetAssetPath(L"skybox.dds");
-    if (LoadDDS(skyboxPath.c_str(), skyboxDesc, true)) {
-        CreateTextureSRV(m_pDevice, skyboxDesc, true, &m_pSkyboxView);
-        delete[] static_cast<char*>(skyboxDesc.pData);
+    // Сообщения об ошибках только из главного потока
+    if (!scene.cubeLoaded) {
+        std::wstring errorMsg = L"Failed to load: " + scene.cubePath.wstring();
+        MessageBoxW(nullptr, errorMsg.c_str(), L"Resource Error", MB_OK | MB_ICONERROR);
     }
-    else {
-        std::wstring errorMsg = L"Failed to load: " + skyboxPath;
+    if (!scene.skyboxLoaded) {
+        std::wstring errorMsg = L"Failed to load: " + scene.skyboxPath.wstring();
         MessageBoxW(nullptr, errorMsg.c_str(), L"Resource Error", MB_OK | MB_ICONERROR);
     }
 
-
+    ReleaseStartupState(state);
     return hr;
 }
 
+// Запуск с -headless: без окна и устройства, см. RunHeadlessStartup в SceneStartup.
+// Компиляция шейдеров входит в замер, D3DCompile устройства не требует.
+// Отчёт пишется в startup_report.txt рядом с exe.
+void WriteHeadlessStartupReport() {
+    std::wstring assetsDir = GetAssetPath(L"");
+    // По набору blob-ов на граф: последовательный и параллельный
+    ID3DBlob* blobs[2][4] = {};
+    int graphIndex = 0;
+    std::string report = RunHeadlessStartup(assetsDir, GetExeDirectory() + L"skybox_specular.dds", [&](TaskGraph& graph) {
+        TaskGraph::TaskId compile[4];
+        AddShaderCompileTasks(graph, blobs[graphIndex++], compile);
+    });
+    for (auto& graphBlobs : blobs) {
+        for (ID3DBlob*& blob : graphBlobs) SAFE_RELEASE(blob);
+    }
+    OutputDebugStringA(report.c_str());
+
+    std::ofstream file(GetExeDirectory() + L"startup_report.txt");
+    file << report;
+}
+
 HRESULT InitDirectX(HWND hWnd) {
     HRESULT result;
     IDXGIFactory* pFactory = nullptr;
@@ -615,6 +714,7 @@ void Render() {
         SceneBuffer* pSceneBuffer = reinterpret_cast<SceneBuffer*>(subresource.pData);
         pSceneBuffer->vp = XMMatrixMultiply(view, proj);
         pSceneBuffer->cameraPos = camPosition;
+        memcpy(pSceneBuffer->ambientSH, m_ambientSH, sizeof(m_ambientSH));
         m_pDeviceContext->Unmap(m_pSceneBuffer, 0);
     }
 
@@ -623,6 +723,7 @@ void Render() {
 
     ID3D11Buffer* constBuffers[] = { m_pGeomBuffer, m_pSceneBuffer };
     m_pDeviceContext->VSSetConstantBuffers(0, 2, constBuffers);
+    m_pDeviceContext->PSSetConstantBuffers(0, 2, constBuffers);
 
     ID3D11SamplerState* samplers[] = { m_pSampler };
     m_pDeviceContext->PSSetSamplers(0, 1, samplers);
@@ -633,6 +734,9 @@ void Render() {
     GeomBuffer skyboxGeom;
     skyboxGeom.model = XMMatrixIdentity();
     skyboxGeom.size = XMVectorSet(sphereRadius, 0.0f, 0.0f, 0.0f);
+    skyboxGeom.posScale = ToFloat4Scale(m_skyboxBounds);
+    skyboxGeom.posOffset = ToFloat4Offset(m_skyboxBounds);
+    skyboxGeom.material = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
     m_pDeviceContext->UpdateSubresource(m_pGeomBuffer, 0, nullptr, &skyboxGeom, 0, 0);
 
     ID3D11ShaderResourceView* skyboxRes[] = { m_pSkyboxView };
@@ -641,8 +745,8 @@ void Render() {
     m_pDeviceContext->VSSetShader(m_pSkyboxVS, nullptr, 0);
     m_pDeviceContext->PSSetShader(m_pSkyboxPS, nullptr, 0);
 
-    m_pDeviceContext->IASetIndexBuffer(m_pSkyboxIB, DXGI_FORMAT_R16_UINT, 0);
-    UINT strideSky = sizeof(SkyboxVertex);
+    m_pDeviceContext->IASetIndexBuffer(m_pSkyboxIB, m_skyboxIndexFormat, 0);
+    UINT strideSky = sizeof(PackedSkyboxVertex);
     UINT offsetSky = 0;
     m_pDeviceContext->IASetVertexBuffers(0, 1, &m_pSkyboxVB, &strideSky, &offsetSky);
     m_pDeviceContext->IASetInputLayout(m_pSkyboxLayout);
@@ -655,20 +759,25 @@ void Render() {
 
     GeomBuffer cubeGeom;
     cubeGeom.model = XMMatrixRotationY(elapsedSec) * XMMatrixRotationX(elapsedSec * 0.5f);
+    cubeGeom.posScale = ToFloat4Scale(m_cubeBounds);
+    cubeGeom.posOffset = ToFloat4Offset(m_cubeBounds);
+    cubeGeom.material = XMFLOAT4(CubeRoughness, 0.0f, 0.0f, 0.0f);
     m_pDeviceContext->UpdateSubresource(m_pGeomBuffer, 0, nullptr, &cubeGeom, 0, 0);
 
-    ID3D11ShaderResourceView* cubeRes[] = { m_pCubeTextureView };
-    m_pDeviceContext->PSSetShaderResources(0, 1, cubeRes);
+    // Без префильтра отражаем исходный skybox, его мипы тоже размыты
+    ID3D11ShaderResourceView* specularView = m_pSkyboxSpecularView ? m_pSkyboxSpecularView : m_pSkyboxView;
+    ID3D11ShaderResourceView* cubeRes[] = { m_pCubeTextureView, specularView };
+    m_pDeviceContext->PSSetShaderResources(0, 2, cubeRes);
 
     m_pDeviceContext->VSSetShader(m_pCubeVS, nullptr, 0);
     m_pDeviceContext->PSSetShader(m_pCubePS, nullptr, 0);
 
-    m_pDeviceContext->IASetIndexBuffer(m_pCubeIB, DXGI_FORMAT_R16_UINT, 0);
-    UINT strideCube = sizeof(TextureVertex);
+    m_pDeviceContext->IASetIndexBuffer(m_pCubeIB, m_cubeIndexFormat, 0);
+    UINT strideCube = sizeof(PackedTextureVertex);
     UINT offsetCube = 0;
     m_pDeviceContext->IASetVertexBuffers(0, 1, &m_pCubeVB, &strideCube, &offsetCube);
     m_pDeviceContext->IASetInputLayout(m_pCubeLayout);
-    m_pDeviceContext->DrawIndexed(36, 0, 0);
+    m_pDeviceContext->DrawIndexed(m_cubeIndexCount, 0, 0);
 
     m_pSwapChain->Present(1, 0);
 }
@@ -679,6 +788,7 @@ void Cleanup() {
     SAFE_RELEASE(m_pRasterizerStateSkybox);
     SAFE_RELEASE(m_pCubeTextureView);
     SAFE_RELEASE(m_pSkyboxView);
+    SAFE_RELEASE(m_pSkyboxSpecularView);
     SAFE_RELEASE(m_pSampler);
     SAFE_RELEASE(m_pSkyboxLayout);
     SAFE_RELEASE(m_pSkyboxPS);
@@ -724,7 +834,12 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
     return DefWindowProc(hWnd, message, wParam, lParam);
 }
 
-int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int nCmdShow) {
+int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR lpCmdLine, int nCmdShow) {
+    if (lpCmdLine && wcsstr(lpCmdLine, L"-headless")) {
+        WriteHeadlessStartupReport();
+        return 0;
+    }
+
     WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, WndProc, 0L, 0L, GetModuleHandle(nullptr), nullptr, nullptr, nullptr, nullptr, L"DX11Lesson", nullptr };
     RegisterClassEx(&wc);
     RECT rc = { 0, 0, (LONG)m_width, (LONG)m_height };
@@ -0,0 +1,56 @@
+#include "ClusteredLighting.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+#include <random>
+
+int main() {
+    ClusterGrid grid;
+    UpdateClusterGrid(grid, 3.14159265f / 3.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+    const float eye[3] = { 0.0f, 1.0f, -3.0f };
+    const float at[3] = { 0.0f, 1.0f, 0.0f };
+    const float up[3] = { 0.0f, 1.0f, 0.0f };
+    float view[16];
+    MakeLookAtLH(eye, at, up, view);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> depth(0.0f, 100.0f);
+    std::uniform_real_distribution<float> range(0.5f, 6.0f);
+
+    printf("Grid %ux%ux%u = %u clusters\n", grid.tilesX, grid.tilesY, grid.slicesZ, grid.ClusterCount());
+    for (size_t count : { 100, 1000, 4000, 10000 }) {
+        std::vector<Light> lights(count);
+        for (size_t i = 0; i < count; ++i) {
+            Light& l = lights[i];
+            l.position[0] = pos(rng);
+            l.position[1] = pos(rng) * 0.5f;
+            l.position[2] = depth(rng);
+            l.range = range(rng);
+            l.direction[0] = 0.0f;
+            l.direction[1] = -1.0f;
+            l.direction[2] = 0.0f;
+            l.spotCosAngle = 0.8f;
+            l.color[0] = l.color[1] = l.color[2] = 1.0f;
+            l.type = i % 3 == 0 ? LightType::Spot : LightType::Point;
+        }
+
+        ClusterLightList list;
+        const int Runs = 5;
+        double best = 1e30;
+        for (int run = 0; run < Runs; ++run) {
+            BenchTimer timer;
+            AssignLights(grid, lights, view, list);
+            best = std::min(best, timer.ElapsedMs());
+        }
+
+        BenchTimer referenceTimer;
+        AssignLightsReference(grid, lights, view, list);
+        double reference = referenceTimer.ElapsedMs();
+
+        printf("%6zu lights: AssignLights %8.3f ms, reference %9.3f ms, x%.1f, %zu light/cluster pairs\n",
+            count, best, reference, reference / best, list.indices.size());
+    }
+    return 0;
+}
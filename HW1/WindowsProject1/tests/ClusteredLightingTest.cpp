@@ -0,0 +1,161 @@
+#include "ClusteredLighting.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// Источники вокруг камеры, примерно треть - прожекторы
+std::vector<Light> MakeLights(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> depth(-5.0f, 100.0f);
+    std::uniform_real_distribution<float> range(0.5f, 8.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> cosAngle(0.2f, 0.98f);
+
+    std::vector<Light> lights(count);
+    for (size_t i = 0; i < count; ++i) {
+        Light& l = lights[i];
+        l.position[0] = pos(rng);
+        l.position[1] = pos(rng) * 0.5f;
+        l.position[2] = depth(rng);
+        l.range = range(rng);
+        l.type = i % 3 == 0 ? LightType::Spot : LightType::Point;
+
+        float d[3] = { unit(rng), unit(rng), unit(rng) };
+        float len = sqrtf(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) + 1e-6f;
+        for (int k = 0; k < 3; ++k) {
+            l.direction[k] = d[k] / len;
+            l.color[k] = 1.0f;
+        }
+        l.spotCosAngle = cosAngle(rng);
+    }
+    return lights;
+}
+
+void TestMatchesReference(size_t count) {
+    ClusterGrid grid;
+    UpdateClusterGrid(grid, 3.14159265f / 3.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+    const float eye[3] = { 1.0f, 2.0f, -3.0f };
+    const float at[3] = { 0.0f, 0.0f, 10.0f };
+    const float up[3] = { 0.0f, 1.0f, 0.0f };
+    float view[16];
+    MakeLookAtLH(eye, at, up, view);
+
+    std::vector<Light> lights = MakeLights(count, static_cast<uint32_t>(count));
+    ClusterLightList fast;
+    ClusterLightList reference;
+    AssignLights(grid, lights, view, fast);
+    AssignLightsReference(grid, lights, view, reference);
+
+    CHECK(fast.offsets.size() == grid.ClusterCount() * 2);
+    CHECK(fast.offsets == reference.offsets);
+    CHECK(fast.indices == reference.indices);
+    CHECK(!fast.indices.empty());
+}
+
+// Проверка без GetViewSphere и AABB кластеров: точки внутри объёма источника переводятся
+// в кластер через проекцию, и каждый такой кластер обязан содержать источник
+void TestSampledVolumes() {
+    const float fov = 3.14159265f / 3.0f;
+    const float aspect = 16.0f / 9.0f;
+    const float nearZ = 0.1f;
+    const float farZ = 100.0f;
+    ClusterGrid grid;
+    UpdateClusterGrid(grid, fov, aspect, nearZ, farZ);
+
+    const float eye[3] = { 1.0f, 2.0f, -3.0f };
+    const float at[3] = { 0.0f, 0.0f, 10.0f };
+    const float up[3] = { 0.0f, 1.0f, 0.0f };
+    float view[16];
+    float proj[16];
+    float viewProj[16];
+    MakeLookAtLH(eye, at, up, view);
+    MakePerspectiveFovLH(fov, aspect, nearZ, farZ, proj);
+    MultiplyMatrices(view, proj, viewProj);
+
+    std::vector<Light> lights = MakeLights(2000, 5);
+    ClusterLightList list;
+    AssignLights(grid, lights, view, list);
+
+    std::mt19937 rng(9);
+    std::normal_distribution<float> gauss;
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    // Отступ от границ тайлов и срезов, чтобы ошибка округления не меняла кластер
+    const double Margin = 1e-3;
+    auto nearBoundary = [Margin](double v) { return fabs(v - floor(v + 0.5)) < Margin; };
+
+    size_t samples = 0;
+    size_t missing = 0;
+    for (uint32_t i = 0; i < lights.size(); ++i) {
+        const Light& l = lights[i];
+        for (int s = 0; s < 128; ++s) {
+            // Случайное направление; для прожектора поворачиваем его внутрь конуса.
+            // Половина точек у внешней границы (край конуса, конец радиуса), где ошибка
+            // ограничивающей сферы заметнее всего.
+            bool rim = s % 2 == 0;
+            float d[3];
+            float len = 0.0f;
+            for (float& v : d) {
+                v = gauss(rng);
+                len += v * v;
+            }
+            len = sqrtf(len);
+            for (float& v : d) v /= len;
+
+            if (l.type == LightType::Spot) {
+                const float* axis = l.direction;
+                float along = d[0] * axis[0] + d[1] * axis[1] + d[2] * axis[2];
+                float perp[3] = { d[0] - axis[0] * along, d[1] - axis[1] * along, d[2] - axis[2] * along };
+                float perpLen = sqrtf(perp[0] * perp[0] + perp[1] * perp[1] + perp[2] * perp[2]);
+                if (perpLen < 1e-3f) continue;
+
+                float cosMin = std::min(1.0f, l.spotCosAngle + 0.002f);
+                float cosB = rim ? cosMin : cosMin + (1.0f - cosMin) * unit(rng);
+                float sinB = sqrtf(std::max(0.0f, 1.0f - cosB * cosB));
+                for (int k = 0; k < 3; ++k) d[k] = axis[k] * cosB + perp[k] / perpLen * sinB;
+            }
+
+            float t = 0.99f * l.range * (rim ? 0.95f + 0.05f * unit(rng) : cbrtf(unit(rng)));
+            double p[4] = { l.position[0] + d[0] * t, l.position[1] + d[1] * t, l.position[2] + d[2] * t, 1.0 };
+            double clip[4] = {};
+            for (int c = 0; c < 4; ++c) {
+                for (int k = 0; k < 4; ++k) clip[c] += p[k] * viewProj[k * 4 + c];
+            }
+
+            double depth = clip[3];
+            if (depth <= nearZ || depth >= farZ) continue;
+            double ndcX = clip[0] / depth;
+            double ndcY = clip[1] / depth;
+            if (fabs(ndcX) >= 1.0 || fabs(ndcY) >= 1.0) continue;
+
+            double tileX = (ndcX + 1.0) * 0.5 * grid.tilesX;
+            double tileY = (1.0 - ndcY) * 0.5 * grid.tilesY;
+            double slice = log(depth / nearZ) / log(farZ / nearZ) * grid.slicesZ;
+            if (nearBoundary(tileX) || nearBoundary(tileY) || nearBoundary(slice)) continue;
+
+            uint32_t cluster = (static_cast<uint32_t>(slice) * grid.tilesY + static_cast<uint32_t>(tileY)) * grid.tilesX
+                + static_cast<uint32_t>(tileX);
+            const uint32_t* begin = list.indices.data() + list.offsets[cluster * 2];
+            const uint32_t* end = begin + list.offsets[cluster * 2 + 1];
+            ++samples;
+            if (std::find(begin, end, i) == end) ++missing;
+        }
+    }
+    printf("sampled %zu points inside light volumes, %zu missing\n", samples, missing);
+    CHECK(samples > 50000);
+    CHECK(missing == 0);
+}
+
+}
+
+int main() {
+    TestMatchesReference(100);
+    TestMatchesReference(1000);
+    TestMatchesReference(10000);
+    TestSampledVolumes();
+    return TestResult("ClusteredLighting");
+}
@@ -0,0 +1,51 @@
+#include "Meshlet.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+
+int main() {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    GenerateTestSphere(400, 400, positions, indices);
+    size_t vertexCount = positions.size() / 3;
+
+    IndexData packed;
+    PackIndices(indices.data(), indices.size(), vertexCount, packed);
+    printf("Sphere: %zu vertices, %zu triangles, %s indices\n", vertexCount, indices.size() / 3,
+        packed.format == IndexFormat::Uint16 ? "16-bit" : "32-bit");
+
+    MeshletData data;
+    const int Runs = 5;
+    double best = 1e30;
+    for (int run = 0; run < Runs; ++run) {
+        BenchTimer timer;
+        BuildMeshlets(positions.data(), vertexCount, sizeof(float) * 3, indices.data(), indices.size(), data);
+        best = std::min(best, timer.ElapsedMs());
+    }
+    printf("BuildMeshlets: %zu meshlets, %.2f ms (best of %d), %.1f Mtri/s\n",
+        data.meshlets.size(), best, Runs, indices.size() / 3 / best / 1e3);
+
+    // Камеры снаружи на разном расстоянии, смотрят на центр сферы
+    const float eyes[][3] = { { 0.0f, 0.0f, -3.0f }, { 0.0f, 0.5f, -1.5f }, { 2.0f, 2.0f, 2.0f }, { 0.0f, 0.0f, -1.1f } };
+    const float at[3] = { 0.0f, 0.0f, 0.0f };
+    const float up[3] = { 0.0f, 1.0f, 0.0f };
+    float proj[16];
+    MakePerspectiveFovLH(3.14159265f / 3.0f, 16.0f / 9.0f, 0.1f, 100.0f, proj);
+
+    std::vector<uint32_t> visible;
+    for (const float* eye : eyes) {
+        float view[16];
+        float vp[16];
+        MakeLookAtLH(eye, at, up, view);
+        MultiplyMatrices(view, proj, vp);
+
+        BenchTimer timer;
+        MeshletCullStats stats = CullMeshlets(data, vp, eye, visible);
+        double ms = timer.ElapsedMs();
+        printf("Camera (%5.2f %5.2f %5.2f): frustum %5.1f%%, back-face %5.1f%%, visible %5.1f%%, %.3f ms\n",
+            eye[0], eye[1], eye[2],
+            100.0 * stats.frustumCulled / stats.total, 100.0 * stats.backfaceCulled / stats.total,
+            100.0 * visible.size() / stats.total, ms);
+    }
+    return 0;
+}
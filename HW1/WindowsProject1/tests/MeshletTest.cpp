@@ -0,0 +1,98 @@
+#include "Meshlet.h"
+#include "TestCommon.h"
+
+#include <random>
+
+namespace {
+
+void TestIndexFormat() {
+    CHECK(ChooseIndexFormat(0) == IndexFormat::Uint16);
+    CHECK(ChooseIndexFormat(65535) == IndexFormat::Uint16);
+    CHECK(ChooseIndexFormat(65536) == IndexFormat::Uint16);
+    CHECK(ChooseIndexFormat(65537) == IndexFormat::Uint32);
+
+    const uint32_t indices[] = { 0, 1, 65535 };
+    IndexData data;
+    PackIndices(indices, 3, 65536, data);
+    CHECK(data.format == IndexFormat::Uint16);
+    CHECK(data.bytes.size() == 6);
+    CHECK(reinterpret_cast<const uint16_t*>(data.bytes.data())[2] == 65535);
+
+    PackIndices(indices, 3, 65537, data);
+    CHECK(data.format == IndexFormat::Uint32);
+    CHECK(data.bytes.size() == 12);
+}
+
+void TestRebuild(const std::vector<float>& positions, const std::vector<uint32_t>& indices,
+    size_t maxVertices, size_t maxTriangles) {
+    MeshletData data;
+    BuildMeshlets(positions.data(), positions.size() / 3, sizeof(float) * 3, indices.data(), indices.size(),
+        data, maxVertices, maxTriangles);
+    CHECK(data.meshlets.size() == data.bounds.size());
+
+    std::vector<uint32_t> rebuilt;
+    for (const Meshlet& m : data.meshlets) {
+        CHECK(m.vertexCount <= maxVertices);
+        CHECK(m.triangleCount <= maxTriangles);
+        CHECK(m.triangleCount > 0);
+        for (uint32_t t = 0; t < m.triangleCount * 3u; ++t) {
+            uint8_t local = data.triangles[m.triangleOffset + t];
+            CHECK(local < m.vertexCount);
+            rebuilt.push_back(data.vertices[m.vertexOffset + local]);
+        }
+    }
+    CHECK(rebuilt == indices);
+}
+
+// Ни один треугольник, повёрнутый к камере, не должен попасть в отсечённый по конусу меслет
+void TestBackfaceConservative(const std::vector<float>& positions, const std::vector<uint32_t>& indices) {
+    MeshletData data;
+    BuildMeshlets(positions.data(), positions.size() / 3, sizeof(float) * 3, indices.data(), indices.size(), data);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    size_t culled = 0;
+    for (int c = 0; c < 64; ++c) {
+        float dir[3] = { dist(rng), dist(rng), dist(rng) };
+        float len = sqrtf(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+        float distance = 1.05f + 4.0f * (c % 8) / 8.0f;
+        float camera[3] = { dir[0] / len * distance, dir[1] / len * distance, dir[2] / len * distance };
+
+        for (size_t i = 0; i < data.meshlets.size(); ++i) {
+            if (!IsMeshletBackfacing(data.bounds[i], camera)) continue;
+            ++culled;
+
+            const Meshlet& m = data.meshlets[i];
+            for (uint32_t t = 0; t < m.triangleCount; ++t) {
+                const float* p[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = &positions[data.vertices[m.vertexOffset + data.triangles[m.triangleOffset + t * 3 + k]] * 3];
+                }
+                float e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+                float e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+                float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                float toCamera[3] = { camera[0] - p[0][0], camera[1] - p[0][1], camera[2] - p[0][2] };
+                float facing = n[0] * toCamera[0] + n[1] * toCamera[1] + n[2] * toCamera[2];
+                float nLen = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                CHECK(facing <= 1e-4f * nLen);
+            }
+        }
+    }
+    CHECK(culled > 0);
+}
+
+}
+
+int main() {
+    TestIndexFormat();
+
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+    GenerateTestSphere(64, 96, positions, indices);
+    TestRebuild(positions, indices, MeshletMaxVertices, MeshletMaxTriangles);
+    TestRebuild(positions, indices, 32, 40);
+    TestRebuild(positions, indices, 255, 255);
+    TestBackfaceConservative(positions, indices);
+
+    return TestResult("Meshlet");
+}
@@ -0,0 +1,25 @@
+#include "SpecularPrefilter.h"
+#include "TestCommon.h"
+
+int main() {
+    DDSImage image;
+    if (!LoadDDSFile(ASSETS_DIR "/skybox.dds", image)) {
+        fprintf(stderr, "skybox.dds not found in %s\n", ASSETS_DIR);
+        return 1;
+    }
+
+    CubemapImage source;
+    DecodeCubemap(image.fmt, image.data.data(), image.width, image.height, image.mipCount, 0, source);
+
+    PrefilterSettings settings;
+    printf("skybox.dds %u^2 -> %u^2, %u mips\n", source.size, settings.outputSize, settings.mipCount);
+    for (uint32_t sampleCount : { 16u, 32u, 64u, 128u, 256u }) {
+        settings.sampleCount = sampleCount;
+        std::vector<CubemapImage> mips;
+        PrefilterStats stats;
+        PrefilterSpecularCubemap(source, settings, mips, &stats);
+        printf("%4u samples: %8.1f ms, %llu samples taken, %.1f Msample/s\n", sampleCount, stats.milliseconds,
+            static_cast<unsigned long long>(stats.samples), stats.samples / stats.milliseconds / 1e3);
+    }
+    return 0;
+}
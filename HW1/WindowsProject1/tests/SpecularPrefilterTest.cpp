@@ -0,0 +1,257 @@
+#include "SpecularPrefilter.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace {
+
+CubemapImage MakeConstantCubemap(uint32_t size, const float rgb[3]) {
+    CubemapImage image;
+    image.size = size;
+    for (std::vector<float>& face : image.faces) {
+        face.resize(static_cast<size_t>(size) * size * 4);
+        for (size_t i = 0; i < face.size(); i += 4) {
+            face[i + 0] = rgb[0];
+            face[i + 1] = rgb[1];
+            face[i + 2] = rgb[2];
+            face[i + 3] = 1.0f;
+        }
+    }
+    return image;
+}
+
+CubemapImage MakeNoiseCubemap(uint32_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> value(0.0f, 1.0f);
+    CubemapImage image;
+    image.size = size;
+    for (std::vector<float>& face : image.faces) {
+        face.resize(static_cast<size_t>(size) * size * 4);
+        for (size_t i = 0; i < face.size(); ++i) face[i] = i % 4 == 3 ? 1.0f : value(rng);
+    }
+    return image;
+}
+
+const float* Texel(const CubemapImage& image, int face, uint32_t x, uint32_t y) {
+    return &image.faces[face][(static_cast<size_t>(y) * image.size + x) * 4];
+}
+
+// Постоянное окружение остаётся постоянным на любом мипе: GGX-свёртка нормирована,
+// тайлы и сшивка рёбер не добавляют швов
+void TestConstantEnvironment() {
+    const float rgb[3] = { 0.25f, 0.5f, 0.75f };
+    PrefilterSettings settings;
+    settings.outputSize = 64;
+    settings.mipCount = 7;
+    settings.sampleCount = 32;
+    std::vector<CubemapImage> mips;
+    PrefilterSpecularCubemap(MakeConstantCubemap(128, rgb), settings, mips);
+    CHECK(mips.size() == 7);
+
+    float worst = 0.0f;
+    for (size_t m = 0; m < mips.size(); ++m) {
+        CHECK(mips[m].size == std::max(1u, 64u >> m));
+        for (int face = 0; face < 6; ++face) {
+            const std::vector<float>& texels = mips[m].faces[face];
+            for (size_t i = 0; i < texels.size(); i += 4) {
+                for (int c = 0; c < 3; ++c) worst = std::max(worst, fabsf(texels[i + c] - rgb[c]));
+            }
+        }
+    }
+    CHECK(worst < 1e-5f);
+}
+
+// Мип 0 - зеркальное отражение: внутренние тексели равны усреднению 2x2 источника
+// (края меняет сшивка). Размер 64 даёт 4 тайла на грань.
+void TestMirrorMip() {
+    CubemapImage source = MakeNoiseCubemap(128, 3);
+    PrefilterSettings settings;
+    settings.outputSize = 64;
+    settings.mipCount = 2;
+    settings.sampleCount = 16;
+    std::vector<CubemapImage> mips;
+    PrefilterSpecularCubemap(source, settings, mips);
+
+    float worst = 0.0f;
+    for (int face = 0; face < 6; ++face) {
+        for (uint32_t y = 1; y + 1 < 64; ++y) {
+            for (uint32_t x = 1; x + 1 < 64; ++x) {
+                const float* out = Texel(mips[0], face, x, y);
+                for (int c = 0; c < 3; ++c) {
+                    float expected = 0.25f * (Texel(source, face, x * 2, y * 2)[c] + Texel(source, face, x * 2 + 1, y * 2)[c]
+                        + Texel(source, face, x * 2, y * 2 + 1)[c] + Texel(source, face, x * 2 + 1, y * 2 + 1)[c]);
+                    worst = std::max(worst, fabsf(out[c] - expected));
+                }
+            }
+        }
+    }
+    CHECK(worst < 1e-5f);
+
+    // При равных размерах мип 0 совпадает с источником
+    settings.outputSize = 128;
+    PrefilterSpecularCubemap(source, settings, mips);
+    worst = 0.0f;
+    for (int face = 0; face < 6; ++face) {
+        for (uint32_t y = 1; y + 1 < 128; ++y) {
+            for (uint32_t x = 1; x + 1 < 128; ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    worst = std::max(worst, fabsf(Texel(mips[0], face, x, y)[c] - Texel(source, face, x, y)[c]));
+                }
+            }
+        }
+    }
+    CHECK(worst < 1e-5f);
+}
+
+// Освещена только грань +X: с ростом roughness центр +X темнеет, а центр +Z
+// (90 градусов от неё) светлеет, -X остаётся тёмной
+void TestLobeSpread() {
+    CubemapImage source = MakeConstantCubemap(64, std::vector<float>(3, 0.0f).data());
+    std::fill(source.faces[0].begin(), source.faces[0].end(), 1.0f);
+
+    PrefilterSettings settings;
+    settings.outputSize = 64;
+    settings.mipCount = 5;
+    settings.sampleCount = 256;
+    std::vector<CubemapImage> mips;
+    PrefilterSpecularCubemap(source, settings, mips);
+
+    float lit[5];
+    float side[5];
+    for (uint32_t m = 0; m < 5; ++m) {
+        uint32_t c = mips[m].size / 2;
+        lit[m] = Texel(mips[m], 0, c, c)[0];
+        side[m] = Texel(mips[m], 4, c, c)[0];
+        CHECK(Texel(mips[m], 1, c, c)[0] < 1e-6f);
+        printf("mip %u (roughness %.2f): +X %.4f, +Z %.4f\n", m, m / 4.0f, lit[m], side[m]);
+    }
+    CHECK(fabsf(lit[0] - 1.0f) < 1e-6f && side[0] < 1e-6f);
+    for (uint32_t m = 1; m < 5; ++m) {
+        CHECK(lit[m] <= lit[m - 1] + 1e-4f);
+        CHECK(side[m] >= side[m - 1] - 1e-4f);
+    }
+    CHECK(lit[4] < 0.9f);
+    CHECK(side[4] > 0.05f);
+}
+
+// После сшивки тексель на ребре и его сосед через ребро на другой грани равны
+void TestEdgeFixup() {
+    PrefilterSettings settings;
+    settings.outputSize = 32;
+    settings.mipCount = 4;
+    settings.sampleCount = 16;
+    std::vector<CubemapImage> mips;
+    PrefilterSpecularCubemap(MakeNoiseCubemap(64, 5), settings, mips);
+
+    size_t pairs = 0;
+    float worst = 0.0f;
+    for (const CubemapImage& mip : mips) {
+        uint32_t size = mip.size;
+        float texelSize = 2.0f / size;
+        for (int face = 0; face < 6; ++face) {
+            for (uint32_t y = 0; y < size; ++y) {
+                for (uint32_t x = 0; x < size; ++x) {
+                    bool edgeX = x == 0 || x == size - 1;
+                    bool edgeY = y == 0 || y == size - 1;
+                    for (int axis = 0; axis < 2; ++axis) {
+                        if ((axis == 0 && !edgeX) || (axis == 1 && !edgeY)) continue;
+                        // Центр соседнего текселя за ребром: полшага за край грани
+                        float u = (x + 0.5f) * texelSize - 1.0f;
+                        float v = (y + 0.5f) * texelSize - 1.0f;
+                        if (axis == 0) u = x == 0 ? -1.0f - 0.5f * texelSize : 1.0f + 0.5f * texelSize;
+                        else v = y == 0 ? -1.0f - 0.5f * texelSize : 1.0f + 0.5f * texelSize;
+
+                        float dir[3];
+                        CubemapTexelDirection(face, u, v, dir);
+                        float nu, nv;
+                        int other = CubemapDirectionToFace(dir, nu, nv);
+                        CHECK(other != face);
+                        uint32_t nx = std::min(static_cast<uint32_t>((nu * 0.5f + 0.5f) * size), size - 1);
+                        uint32_t ny = std::min(static_cast<uint32_t>((nv * 0.5f + 0.5f) * size), size - 1);
+
+                        const float* a = Texel(mip, face, x, y);
+                        const float* b = Texel(mip, other, nx, ny);
+                        for (int c = 0; c < 3; ++c) worst = std::max(worst, fabsf(a[c] - b[c]));
+                        ++pairs;
+                    }
+                }
+            }
+        }
+    }
+    CHECK(pairs > 6 * 4 * 32);
+    CHECK(worst < 1e-6f);
+}
+
+// Уникальные имена, чтобы параллельные запуски ctest не делили файлы
+std::string UniqueSuffix() {
+    std::random_device device;
+    return std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_" + std::to_string(device());
+}
+
+void TestCacheKey() {
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+    std::string suffix = UniqueSuffix();
+    std::filesystem::path source = dir / ("prefilter_test_source_" + suffix + ".bin");
+    std::filesystem::path cache = dir / ("prefilter_test_cache_" + suffix + ".dds");
+    {
+        std::ofstream file(source, std::ios::binary);
+        file << "skybox";
+    }
+
+    CubemapImage white;
+    white.size = 8;
+    for (std::vector<float>& face : white.faces) face.assign(8 * 8 * 4, 1.0f);
+
+    PrefilterSettings settings;
+    settings.outputSize = 8;
+    settings.mipCount = 3;
+    settings.sampleCount = 8;
+    std::vector<CubemapImage> mips;
+    PrefilterSpecularCubemap(white, settings, mips);
+    CHECK(mips.size() == 3);
+
+    PrefilterCacheKey key;
+    CHECK(MakePrefilterCacheKey(source, settings, key));
+    CHECK(SaveCubemapMipsDDS(cache, mips, &key));
+    CHECK(IsPrefilterCacheValid(cache, key));
+
+    DDSImage image;
+    CHECK(LoadDDSFile(cache, image));
+    CHECK(image.isCubemap && image.width == 8 && image.mipCount == 3);
+
+    // Другие настройки или изменённый исходник делают кэш устаревшим
+    PrefilterSettings moreSamples = settings;
+    moreSamples.sampleCount = 16;
+    PrefilterCacheKey other;
+    CHECK(MakePrefilterCacheKey(source, moreSamples, other));
+    CHECK(!IsPrefilterCacheValid(cache, other));
+
+    {
+        std::ofstream file(source, std::ios::binary | std::ios::app);
+        file << "changed";
+    }
+    CHECK(MakePrefilterCacheKey(source, settings, other));
+    CHECK(!IsPrefilterCacheValid(cache, other));
+
+    // Файл без ключа не принимается
+    CHECK(SaveCubemapMipsDDS(cache, mips));
+    CHECK(!IsPrefilterCacheValid(cache, key));
+    CHECK(!MakePrefilterCacheKey(dir / ("prefilter_test_missing_" + suffix + ".bin"), settings, other));
+
+    std::filesystem::remove(source);
+    std::filesystem::remove(cache);
+}
+
+}
+
+int main() {
+    TestConstantEnvironment();
+    TestMirrorMip();
+    TestLobeSpread();
+    TestEdgeFixup();
+    TestCacheKey();
+    return TestResult("SpecularPrefilter");
+}
@@ -0,0 +1,37 @@
+#include "SphericalHarmonics.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+
+int main() {
+    DDSImage image;
+    if (!LoadDDSFile(ASSETS_DIR "/skybox.dds", image)) {
+        fprintf(stderr, "skybox.dds not found in %s\n", ASSETS_DIR);
+        return 1;
+    }
+    printf("skybox.dds: %ux%u, %u mips\n", image.width, image.height, image.mipCount);
+
+    for (uint32_t mip = 0; mip < std::min(image.mipCount, 4u); ++mip) {
+        BenchTimer decodeTimer;
+        CubemapImage cubemap;
+        DecodeCubemap(image.fmt, image.data.data(), image.width, image.height, image.mipCount, mip, cubemap);
+        double decodeMs = decodeTimer.ElapsedMs();
+
+        const int Runs = 5;
+        double best = 1e30;
+        for (int run = 0; run < Runs; ++run) {
+            BenchTimer timer;
+            ProjectCubemapSH(cubemap);
+            best = std::min(best, timer.ElapsedMs());
+        }
+
+        BenchTimer referenceTimer;
+        ProjectCubemapSHReference(cubemap);
+        double reference = referenceTimer.ElapsedMs();
+
+        double texels = 6.0 * cubemap.size * cubemap.size;
+        printf("mip %u (%4u^2): decode %7.2f ms, SH %7.2f ms (%6.1f Mtexel/s), reference %8.2f ms\n",
+            mip, cubemap.size, decodeMs, best, texels / best / 1e3, reference);
+    }
+    return 0;
+}
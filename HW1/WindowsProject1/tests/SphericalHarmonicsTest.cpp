@@ -0,0 +1,102 @@
+#include "SphericalHarmonics.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+
+namespace {
+
+const float Pi = 3.14159265358979f;
+
+void FillCubemap(CubemapImage& cubemap, uint32_t size, const float faceColor[6]) {
+    cubemap.size = size;
+    for (int face = 0; face < 6; ++face) {
+        cubemap.faces[face].assign(static_cast<size_t>(size) * size * 4, faceColor[face]);
+    }
+}
+
+// Быстрая версия берёт телесный угол текселя по центру, эталон - точную площадь на сфере.
+// Разница квадратур убывает как 1/size^2.
+void CheckMatchesReference(const CubemapImage& cubemap) {
+    SH9Color fast = ProjectCubemapSH(cubemap);
+    SH9Color reference = ProjectCubemapSHReference(cubemap);
+    float relative = 1e-4f + 0.5f / (static_cast<float>(cubemap.size) * cubemap.size);
+    for (int i = 0; i < 9; ++i) {
+        for (int ch = 0; ch < 3; ++ch) {
+            float tolerance = relative * std::max(1.0f, fabsf(reference.c[i][ch]));
+            CHECK(fabsf(fast.c[i][ch] - reference.c[i][ch]) <= tolerance);
+        }
+    }
+}
+
+// Белое окружение: irradiance = pi, после PackIrradianceSH отклик 1 в любом направлении
+void TestConstant() {
+    const float white[6] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+    CubemapImage cubemap;
+    FillCubemap(cubemap, 32, white);
+
+    SH9Color sh = ProjectCubemapSH(cubemap);
+    CHECK(fabsf(sh.c[0][0] - 2.0f * sqrtf(Pi)) < 1e-3f);
+    for (int i = 1; i < 9; ++i) CHECK(fabsf(sh.c[i][0]) < 1e-4f);
+
+    float packed[9][4];
+    PackIrradianceSH(sh, packed);
+    const float normals[][3] = { { 1, 0, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0.577350f, 0.577350f, -0.577350f } };
+    for (const float* n : normals) {
+        float rgb[3];
+        EvaluateIrradianceSH(packed, n, rgb);
+        for (float c : rgb) CHECK(fabsf(c - 1.0f) < 1e-3f);
+    }
+    CheckMatchesReference(cubemap);
+}
+
+// Светится только грань +Y: отклик максимален вверх, одинаков по сторонам и почти нулевой вниз
+void TestSingleFace() {
+    const float topOnly[6] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f };
+    CubemapImage cubemap;
+    FillCubemap(cubemap, 32, topOnly);
+
+    SH9Color sh = ProjectCubemapSH(cubemap);
+    float packed[9][4];
+    PackIrradianceSH(sh, packed);
+
+    const float up[3] = { 0, 1, 0 };
+    const float down[3] = { 0, -1, 0 };
+    const float sides[4][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    float rgbUp[3], rgbDown[3], rgbSide[4][3];
+    EvaluateIrradianceSH(packed, up, rgbUp);
+    EvaluateIrradianceSH(packed, down, rgbDown);
+    for (int s = 0; s < 4; ++s) EvaluateIrradianceSH(packed, sides[s], rgbSide[s]);
+
+    CHECK(rgbUp[0] > rgbSide[0][0]);
+    CHECK(rgbSide[0][0] > rgbDown[0]);
+    CHECK(fabsf(rgbDown[0]) < 0.05f);
+    for (int s = 1; s < 4; ++s) CHECK(fabsf(rgbSide[s][0] - rgbSide[0][0]) < 1e-4f);
+    // Грань видна из центра под телесным углом 4pi/6, отклик вверх меньше 1 и больше 1/6
+    CHECK(rgbUp[0] < 1.0f && rgbUp[0] > 1.0f / 6.0f);
+    CheckMatchesReference(cubemap);
+}
+
+void TestSkybox() {
+    DDSImage image;
+    if (!LoadDDSFile(ASSETS_DIR "/skybox.dds", image)) {
+        fprintf(stderr, "skybox.dds not found in %s\n", ASSETS_DIR);
+        CHECK(false);
+        return;
+    }
+    CHECK(image.isCubemap);
+
+    for (uint32_t mip : { 0u, 2u, 5u }) {
+        CubemapImage cubemap;
+        CHECK(DecodeCubemap(image.fmt, image.data.data(), image.width, image.height, image.mipCount, mip, cubemap));
+        CheckMatchesReference(cubemap);
+    }
+}
+
+}
+
+int main() {
+    TestConstant();
+    TestSingleFace();
+    TestSkybox();
+    return TestResult("SphericalHarmonics");
+}
@@ -0,0 +1,155 @@
+#include "SceneStartup.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "TestCommon.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Порядок завершения задач, индекс - TaskId
+struct OrderLog {
+    std::atomic<int> counter{ 0 };
+    int finished[5] = {};
+
+    void Finish(int id) { finished[id] = ++counter; }
+};
+
+void BuildDiamond(TaskGraph& graph, OrderLog& log) {
+    auto work = [&log](int id) {
+        return [&log, id] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            log.Finish(id);
+        };
+    };
+    TaskGraph::TaskId a = graph.Add("a", work(0));
+    TaskGraph::TaskId b = graph.Add("b", work(1), { a });
+    TaskGraph::TaskId c = graph.Add("c", work(2), { a });
+    graph.Add("d", work(3), { b, c });
+    graph.Add("e", work(4));
+}
+
+void TestDependencies() {
+    for (int serial = 0; serial < 2; ++serial) {
+        TaskGraph graph;
+        OrderLog log;
+        BuildDiamond(graph, log);
+        if (serial) graph.RunSerial();
+        else graph.Run();
+
+        CHECK(log.counter == 5);
+        CHECK(log.finished[0] < log.finished[1]);
+        CHECK(log.finished[0] < log.finished[2]);
+        CHECK(log.finished[1] < log.finished[3]);
+        CHECK(log.finished[2] < log.finished[3]);
+        CHECK(graph.GetTimings().size() == 5);
+        CHECK(graph.GetTimings()[3].name == "d");
+        CHECK(graph.GetTimings()[3].startMs >= graph.GetTimings()[1].startMs + graph.GetTimings()[1].durationMs);
+    }
+}
+
+// Вложенный ParallelFor при RunSerial не уходит в пул
+void TestSerialScope() {
+    CHECK(!SerialScope::IsActive());
+
+    std::thread::id caller = std::this_thread::get_id();
+    std::mutex mutex;
+    std::vector<std::thread::id> threads;
+    std::vector<size_t> order;
+
+    TaskGraph graph;
+    graph.Add("nested", [&] {
+        CHECK(SerialScope::IsActive());
+        ParallelFor(64, [&](size_t i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.push_back(std::this_thread::get_id());
+            order.push_back(i);
+        });
+    });
+    graph.RunSerial();
+
+    CHECK(threads.size() == 64);
+    for (size_t i = 0; i < threads.size(); ++i) {
+        CHECK(threads[i] == caller);
+        CHECK(order[i] == i);
+    }
+    CHECK(!SerialScope::IsActive());
+
+    {
+        SerialScope outer;
+        {
+            SerialScope inner;
+            CHECK(SerialScope::IsActive());
+        }
+        CHECK(SerialScope::IsActive());
+    }
+    CHECK(!SerialScope::IsActive());
+}
+
+// Ускорение в отчёте: сумма стадий последовательного запуска / wall параллельного
+void TestReportRatio() {
+    auto build = [](TaskGraph& graph) {
+        for (int i = 0; i < 4; ++i) {
+            graph.Add("sleep", [] { std::this_thread::sleep_for(std::chrono::milliseconds(5)); });
+        }
+    };
+    TaskGraph serialGraph;
+    build(serialGraph);
+    serialGraph.RunSerial();
+
+    TaskGraph parallelGraph;
+    build(parallelGraph);
+    parallelGraph.Run();
+
+    char expected[128];
+    double serialMs = serialGraph.GetSerialSumMs();
+    snprintf(expected, sizeof(expected), "Startup: wall %.1f ms, serial %.1f ms, x%.2f\n",
+        parallelGraph.GetWallMs(), serialMs, serialMs / parallelGraph.GetWallMs());
+    std::string report = parallelGraph.Report(&serialGraph);
+    CHECK(report.compare(0, strlen(expected), expected) == 0);
+    CHECK(serialMs >= 20.0);
+
+    // Без базового замера ускорение не выводится
+    CHECK(parallelGraph.Report().find(" x") == std::string::npos);
+}
+
+// Стадии CPU приложения на настоящих ассетах
+void TestSceneStartup() {
+    TaskGraph graph;
+    SceneStartupData data;
+    data.cubePath = std::filesystem::path(ASSETS_DIR) / "vect.dds";
+    data.skyboxPath = std::filesystem::path(ASSETS_DIR) / "skybox.dds";
+    AddSceneStartupTasks(graph, data);
+    graph.Run();
+
+    CHECK(data.cubeLoaded);
+    CHECK(data.skyboxLoaded && data.skyboxTexture.isCubemap);
+    CHECK(data.ambientReady);
+    CHECK(data.specularReady && !data.specularFromCache);
+    CHECK(data.specularTexture.isCubemap && data.specularTexture.mipCount == PrefilterSettings().mipCount);
+    CHECK(data.ambientSH[0][0] > 0.0f);
+
+    // 20x20 с полюсами: 19 колец по 21 вершине
+    CHECK(data.sphereVertices.size() == (19 * 21 + 2) * 4);
+    CHECK(data.sphereIndices.count == 20 * 3 * 2 + 18 * 20 * 6);
+    CHECK(data.sphereIndices.format == IndexFormat::Uint16);
+
+    std::string report = RunHeadlessStartup(ASSETS_DIR);
+    CHECK(report.find("Failed") == std::string::npos);
+    CHECK(report.find("serial") != std::string::npos);
+    printf("%s", report.c_str());
+}
+
+}
+
+int main() {
+    TestDependencies();
+    TestSerialScope();
+    TestReportRatio();
+    TestSceneStartup();
+    return TestResult("TaskGraph");
+}
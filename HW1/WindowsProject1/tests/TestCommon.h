@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Минимальный набор для тестов без внешних зависимостей
+
+inline int& TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++TestFailures(); \
+        } \
+    } while (0)
+
+inline int TestResult(const char* name) {
+    if (TestFailures()) {
+        printf("%s: %d check(s) failed\n", name, TestFailures());
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+class BenchTimer {
+public:
+    BenchTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+    double ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Матрицы row-major с вектором-строкой, как XMMatrixLookAtLH / XMMatrixPerspectiveFovLH
+
+inline void MakeLookAtLH(const float eye[3], const float at[3], const float up[3], float m[16]) {
+    auto normalize = [](float v[3]) {
+        float len = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        for (int i = 0; i < 3; ++i) v[i] /= len;
+    };
+    auto cross = [](const float a[3], const float b[3], float out[3]) {
+        out[0] = a[1] * b[2] - a[2] * b[1];
+        out[1] = a[2] * b[0] - a[0] * b[2];
+        out[2] = a[0] * b[1] - a[1] * b[0];
+    };
+    auto dot = [](const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; };
+
+    float z[3] = { at[0] - eye[0], at[1] - eye[1], at[2] - eye[2] };
+    normalize(z);
+    float x[3];
+    cross(up, z, x);
+    normalize(x);
+    float y[3];
+    cross(z, x, y);
+
+    float rows[16] = {
+        x[0], y[0], z[0], 0.0f,
+        x[1], y[1], z[1], 0.0f,
+        x[2], y[2], z[2], 0.0f,
+        -dot(x, eye), -dot(y, eye), -dot(z, eye), 1.0f,
+    };
+    for (int i = 0; i < 16; ++i) m[i] = rows[i];
+}
+
+inline void MakePerspectiveFovLH(float fov, float aspect, float nearZ, float farZ, float m[16]) {
+    float h = 1.0f / tanf(fov * 0.5f);
+    float range = farZ / (farZ - nearZ);
+    float rows[16] = {
+        h / aspect, 0.0f, 0.0f, 0.0f,
+        0.0f, h, 0.0f, 0.0f,
+        0.0f, 0.0f, range, 1.0f,
+        0.0f, 0.0f, -range * nearZ, 0.0f,
+    };
+    for (int i = 0; i < 16; ++i) m[i] = rows[i];
+}
+
+inline void MultiplyMatrices(const float a[16], const float b[16], float out[16]) {
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; ++k) sum += a[i * 4 + k] * b[k * 4 + j];
+            out[i * 4 + j] = sum;
+        }
+    }
+}
+
+// UV-сфера радиуса 1, у полюсов вырожденные треугольники
+inline void GenerateTestSphere(uint32_t latLines, uint32_t longLines, std::vector<float>& positions, std::vector<uint32_t>& indices) {
+    const float Pi = 3.14159265358979f;
+    positions.clear();
+    indices.clear();
+    for (uint32_t lat = 0; lat <= latLines; ++lat) {
+        float phi = Pi * lat / latLines;
+        for (uint32_t lon = 0; lon <= longLines; ++lon) {
+            float theta = 2.0f * Pi * lon / longLines;
+            positions.push_back(sinf(phi) * cosf(theta));
+            positions.push_back(cosf(phi));
+            positions.push_back(sinf(phi) * sinf(theta));
+        }
+    }
+    for (uint32_t lat = 0; lat < latLines; ++lat) {
+        for (uint32_t lon = 0; lon < longLines; ++lon) {
+            uint32_t first = lat * (longLines + 1) + lon;
+            uint32_t second = first + longLines + 1;
+            indices.insert(indices.end(), { first, first + 1, second, second, first + 1, second + 1 });
+        }
+    }
+}
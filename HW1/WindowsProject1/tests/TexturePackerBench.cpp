@@ -0,0 +1,54 @@
+#include "TexturePacker.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+#include <random>
+
+int main() {
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> sizeLog(3, 8);
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+
+    for (size_t count : { 64, 256, 1024 }) {
+        std::vector<std::vector<uint8_t>> storage(count);
+        std::vector<PackerTexture> textures(count);
+        for (size_t i = 0; i < count; ++i) {
+            PackerTexture& t = textures[i];
+            t.fmt = TexelFormat::BC1;
+            t.width = 1u << sizeLog(rng);
+            t.height = 1u << sizeLog(rng);
+            t.mipCount = 1;
+            while ((std::max(t.width, t.height) >> t.mipCount) > 0) ++t.mipCount;
+            storage[i].resize(GetSubresourceOffset(t.fmt, t.width, t.height, t.mipCount, 1, 0));
+            for (uint8_t& b : storage[i]) b = static_cast<uint8_t>(byte(rng));
+            t.pData = storage[i].data();
+        }
+
+        for (uint32_t maxMips : { 1u, 3u, 5u }) {
+            AtlasSettings settings;
+            settings.maxMips = maxMips;
+            std::vector<AtlasPage> pages;
+            std::vector<AtlasEntry> entries;
+            AtlasStats stats;
+
+            BenchTimer timer;
+            bool ok = PackAtlas(textures, settings, pages, entries, &stats);
+            double ms = timer.ElapsedMs();
+
+            uint32_t maxW = 0, maxH = 0;
+            for (const AtlasPage& page : pages) {
+                maxW = std::max(maxW, page.width);
+                maxH = std::max(maxH, page.height);
+            }
+            printf("%5zu textures, %u mips: %s, %zu page(s) up to %ux%u, density %5.1f%%, %7.2f ms\n",
+                count, maxMips, ok ? "ok" : "failed", pages.size(), maxW, maxH, 100.0 * stats.Density(), ms);
+        }
+
+        std::vector<TextureArray> arrays;
+        std::vector<ArrayEntry> arrayEntries;
+        BenchTimer timer;
+        PackTextureArrays(textures, arrays, arrayEntries);
+        printf("%5zu textures: %zu texture arrays, %.2f ms\n", count, arrays.size(), timer.ElapsedMs());
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "TexturePacker.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+struct SourceTexture {
+    uint32_t width, height, mipCount;
+    std::vector<uint8_t> data;
+};
+
+// Случайные блоки: в BC1 встречаются оба режима палитры
+std::vector<SourceTexture> MakeTextures(TexelFormat fmt, size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> blocks(1, 24);
+    std::uniform_int_distribution<uint32_t> byte(0, 255);
+
+    std::vector<SourceTexture> textures(count);
+    for (SourceTexture& t : textures) {
+        t.width = blocks(rng) * 4;
+        t.height = blocks(rng) * 4;
+        t.mipCount = 1;
+        while ((std::max(t.width, t.height) >> t.mipCount) > 0) ++t.mipCount;
+        t.data.resize(GetSubresourceOffset(fmt, t.width, t.height, t.mipCount, 1, 0));
+        for (uint8_t& b : t.data) b = static_cast<uint8_t>(byte(rng));
+    }
+    return textures;
+}
+
+struct Rect {
+    uint32_t page;
+    int64_t x0, y0, x1, y1;
+};
+
+// Конец области текстуры с полем по одной оси: на каждом мипе нужен хотя бы тексель повтора
+// за краем, округлённый до блока
+int64_t GutterEnd(int64_t origin, uint32_t size, uint32_t mipCount) {
+    int64_t end = 0;
+    for (uint32_t mip = 0; mip < mipCount; ++mip) {
+        int64_t mipSize = std::max(1u, size >> mip);
+        end = std::max(end, ((origin >> mip) + (mipSize + 1 + 3) / 4 * 4) << mip);
+    }
+    return end;
+}
+
+void TestAtlas(TexelFormat fmt, uint32_t maxMips, uint32_t seed, double minDensity) {
+    std::vector<SourceTexture> sources = MakeTextures(fmt, 80, seed);
+    std::vector<PackerTexture> textures;
+    for (const SourceTexture& s : sources) {
+        textures.push_back({ fmt, s.width, s.height, s.mipCount, s.data.data() });
+    }
+
+    AtlasSettings settings;
+    settings.maxPageSize = 512;
+    settings.maxMips = maxMips;
+    std::vector<AtlasPage> pages;
+    std::vector<AtlasEntry> entries;
+    AtlasStats stats;
+    CHECK(PackAtlas(textures, settings, pages, entries, &stats));
+    CHECK(!pages.empty());
+    // Нижняя граница по замеру для этого набора, плотность падает с ростом ячейки
+    CHECK(stats.Density() >= minDensity && stats.Density() <= 1.0);
+
+    const uint32_t mipCount = pages[0].mipCount;
+    CHECK(mipCount == maxMips);
+    const int64_t cell = 4 << (mipCount - 1);
+
+    // Прямоугольники вместе с полем не пересекаются и лежат внутри страницы
+    std::vector<Rect> rects;
+    for (size_t i = 0; i < textures.size(); ++i) {
+        const AtlasPage& page = pages[entries[i].page];
+        int64_t x = std::llround(entries[i].uvOffset[0] * page.width);
+        int64_t y = std::llround(entries[i].uvOffset[1] * page.height);
+        CHECK(x % cell == 0 && y % cell == 0);
+        CHECK(std::llround(entries[i].uvScale[0] * page.width) == textures[i].width);
+        CHECK(std::llround(entries[i].uvScale[1] * page.height) == textures[i].height);
+
+        Rect r = { entries[i].page, x - cell, y - cell,
+            GutterEnd(x, textures[i].width, mipCount), GutterEnd(y, textures[i].height, mipCount) };
+        CHECK(r.x0 >= 0 && r.y0 >= 0 && r.x1 <= page.width && r.y1 <= page.height);
+        for (const Rect& other : rects) {
+            bool overlap = r.page == other.page && r.x0 < other.x1 && other.x0 < r.x1 && r.y0 < other.y1 && other.y0 < r.y1;
+            CHECK(!overlap);
+        }
+        rects.push_back(r);
+    }
+
+    // На каждом мипе: смещение кратно блоку, внутри текстуры тексели совпадают с исходными,
+    // в поле повторяются краевые тексели
+    for (uint32_t mip = 0; mip < mipCount; ++mip) {
+        std::vector<std::vector<float>> decodedPages(pages.size());
+        for (size_t p = 0; p < pages.size(); ++p) {
+            const AtlasPage& page = pages[p];
+            size_t offset = GetSubresourceOffset(fmt, page.width, page.height, page.mipCount, 0, mip);
+            CHECK(DecodeSurface(fmt, page.data.data() + offset, page.width >> mip, page.height >> mip, decodedPages[p]));
+        }
+
+        for (size_t i = 0; i < textures.size(); ++i) {
+            const Rect& r = rects[i];
+            uint32_t pageW = pages[r.page].width >> mip;
+            int64_t texX = (r.x0 + cell) >> mip;
+            int64_t texY = (r.y0 + cell) >> mip;
+            CHECK(texX % 4 == 0 && texY % 4 == 0);
+
+            uint32_t srcW = std::max(1u, textures[i].width >> mip);
+            uint32_t srcH = std::max(1u, textures[i].height >> mip);
+            std::vector<float> src;
+            size_t srcOffset = GetSubresourceOffset(fmt, textures[i].width, textures[i].height, textures[i].mipCount, 0, mip);
+            CHECK(DecodeSurface(fmt, sources[i].data.data() + srcOffset, srcW, srcH, src));
+
+            size_t mismatches = 0;
+            for (int64_t y = r.y0 >> mip; y < r.y1 >> mip; ++y) {
+                for (int64_t x = r.x0 >> mip; x < r.x1 >> mip; ++x) {
+                    int64_t sx = std::clamp<int64_t>(x - texX, 0, srcW - 1);
+                    int64_t sy = std::clamp<int64_t>(y - texY, 0, srcH - 1);
+                    const float* expected = &src[(sy * srcW + sx) * 4];
+                    const float* actual = &decodedPages[r.page][(y * pageW + x) * 4];
+                    if (!std::equal(expected, expected + 4, actual)) ++mismatches;
+                }
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+}
+
+// Набор как в TexturePackerBench: 256 текстур BC1 со сторонами 8..256. Плотность зависит только от размеров.
+void TestDensity() {
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> sizeLog(3, 8);
+    std::vector<uint8_t> zeros(GetSubresourceOffset(TexelFormat::BC1, 256, 256, 9, 1, 0), 0);
+
+    std::vector<PackerTexture> textures(256);
+    for (PackerTexture& t : textures) {
+        t.fmt = TexelFormat::BC1;
+        t.width = 1u << sizeLog(rng);
+        t.height = 1u << sizeLog(rng);
+        while ((std::max(t.width, t.height) >> t.mipCount) > 0) ++t.mipCount;
+        t.pData = zeros.data();
+    }
+
+    // Замер: 74% при 1 мипе, 48% при 3, 30% при 5 (46% и 27% с полем в целую ячейку с каждой стороны)
+    const struct { uint32_t maxMips; double minDensity; } cases[] = { { 1, 0.70 }, { 3, 0.47 }, { 5, 0.29 } };
+    for (const auto& c : cases) {
+        AtlasSettings settings;
+        settings.maxMips = c.maxMips;
+        std::vector<AtlasPage> pages;
+        std::vector<AtlasEntry> entries;
+        AtlasStats stats;
+        CHECK(PackAtlas(textures, settings, pages, entries, &stats));
+        CHECK(stats.Density() >= c.minDensity);
+    }
+}
+
+void TestArrays() {
+    std::vector<SourceTexture> sources = MakeTextures(TexelFormat::BC1, 40, 3);
+    std::vector<PackerTexture> textures;
+    for (const SourceTexture& s : sources) {
+        textures.push_back({ TexelFormat::BC1, s.width % 8 ? 8u : 16u, 16, 1, s.data.data() });
+    }
+
+    std::vector<TextureArray> arrays;
+    std::vector<ArrayEntry> entries;
+    PackTextureArrays(textures, arrays, entries);
+    CHECK(arrays.size() == 2);
+    for (size_t i = 0; i < textures.size(); ++i) {
+        const TextureArray& a = arrays[entries[i].array];
+        CHECK(a.width == textures[i].width);
+        size_t sliceSize = GetSubresourceOffset(a.fmt, a.width, a.height, a.mipCount, 1, 0);
+        CHECK(std::equal(sources[i].data.begin(), sources[i].data.begin() + sliceSize, a.data.begin() + sliceSize * entries[i].slice));
+    }
+}
+
+}
+
+int main() {
+    TestAtlas(TexelFormat::BC1, 1, 1, 0.55);
+    TestAtlas(TexelFormat::BC1, 3, 2, 0.32);
+    TestAtlas(TexelFormat::BC3, 2, 3, 0.48);
+    TestAtlas(TexelFormat::BC2, 3, 4, 0.37);
+    TestDensity();
+    TestArrays();
+    return TestResult("TexturePacker");
+}
@@ -0,0 +1,116 @@
+#include "VertexQuantization.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+struct SourceVertex {
+    float pos[3];
+    float normal[3];
+    float uv[2];
+};
+
+// Вершины приложения до и после сжатия
+struct TextureVertex {
+    float pos[3];
+    float uv[2];
+};
+
+struct PackedTextureVertex {
+    int16_t pos[4];
+    uint16_t uv[2];
+};
+
+struct SkyboxVertex {
+    float pos[3];
+};
+
+struct PackedSkyboxVertex {
+    int16_t pos[4];
+};
+
+struct PackedVertex {
+    int16_t pos[4];
+    int16_t normal[2];
+    uint16_t uv[2];
+};
+
+uint32_t AttributeSize(VertexAttributeFormat format) {
+    return GetVertexAttributeDesc(format).size;
+}
+
+void PrintBytesPerVertex(const char* name, size_t source, size_t packed, uint32_t layout) {
+    printf("  %-24s %2zu -> %2zu bytes (layout %2u)\n", name, source, packed, layout);
+}
+
+// Лучшее из нескольких запусков, млн вершин в секунду
+template <typename Fn>
+double MeasureMverts(size_t count, Fn fn) {
+    const int Runs = 7;
+    double best = 1e30;
+    for (int run = 0; run < Runs; ++run) {
+        BenchTimer timer;
+        fn();
+        best = std::min(best, timer.ElapsedMs());
+    }
+    return count / best / 1e3;
+}
+
+}
+
+int main() {
+#ifdef QUANT_NO_SSE
+    const char* path = "scalar";
+#else
+    const char* path = "default (SSE2 where available)";
+#endif
+    const size_t Count = 1 << 20;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> gauss;
+
+    std::vector<SourceVertex> vertices(Count);
+    for (SourceVertex& v : vertices) {
+        for (float& p : v.pos) p = pos(rng);
+        float len = 0.0f;
+        for (float& n : v.normal) {
+            n = gauss(rng);
+            len += n * n;
+        }
+        for (float& n : v.normal) n /= sqrtf(len);
+        v.uv[0] = unit(rng);
+        v.uv[1] = unit(rng);
+    }
+    std::vector<uint8_t> out(Count * 8);
+
+    QuantizationBounds bounds;
+    ComputeQuantizationBounds(vertices[0].pos, Count, sizeof(SourceVertex), bounds);
+
+    const uint32_t posSize = AttributeSize(VertexAttributeFormat::PositionSnorm16);
+    const uint32_t halfSize = AttributeSize(VertexAttributeFormat::PositionHalf);
+    const uint32_t uvSize = AttributeSize(VertexAttributeFormat::TexcoordUnorm16);
+    const uint32_t normalSize = AttributeSize(VertexAttributeFormat::NormalOctahedral);
+
+    printf("%zu vertices, source stride %zu bytes, %s path\n", Count, sizeof(SourceVertex), path);
+    printf("  position snorm16   %7.1f Mvert/s\n", MeasureMverts(Count, [&] {
+        QuantizePositionsSnorm16(vertices[0].pos, Count, sizeof(SourceVertex), bounds, out.data(), posSize);
+    }));
+    printf("  position half      %7.1f Mvert/s\n", MeasureMverts(Count, [&] {
+        QuantizePositionsHalf(vertices[0].pos, Count, sizeof(SourceVertex), out.data(), halfSize);
+    }));
+    printf("  texcoord unorm16   %7.1f Mvert/s\n", MeasureMverts(Count, [&] {
+        QuantizeTexcoordsUnorm16(vertices[0].uv, Count, sizeof(SourceVertex), out.data(), uvSize);
+    }));
+    printf("  normal octahedral  %7.1f Mvert/s\n", MeasureMverts(Count, [&] {
+        QuantizeNormalsOctahedral(vertices[0].normal, Count, sizeof(SourceVertex), out.data(), normalSize);
+    }));
+
+    printf("bytes per vertex:\n");
+    PrintBytesPerVertex("textured (pos + uv)", sizeof(TextureVertex), sizeof(PackedTextureVertex), posSize + uvSize);
+    PrintBytesPerVertex("skybox (pos)", sizeof(SkyboxVertex), sizeof(PackedSkyboxVertex), posSize);
+    PrintBytesPerVertex("pos + normal + uv", sizeof(SourceVertex), sizeof(PackedVertex), posSize + normalSize + uvSize);
+    return 0;
+}
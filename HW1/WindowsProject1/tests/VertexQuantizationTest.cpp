@@ -0,0 +1,292 @@
+#include "VertexQuantization.h"
+#include "TestCommon.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace {
+
+// Нечётное количество: основной цикл по 2 и по 4 вершины плюс хвост
+const size_t VertexCount = 1003;
+
+// Чередующиеся вершины, как в буфере приложения
+struct SourceVertex {
+    float pos[3];
+    float normal[3];
+    float uv[2];
+};
+
+struct PackedVertex {
+    int16_t pos[4];
+    int16_t normal[2];
+    uint16_t uv[2];
+};
+
+// Скалярные формулы Quantize*: округление к чётному, как _mm_cvtps_epi32
+int16_t ReferenceSnorm16(float v) {
+    return static_cast<int16_t>(lrintf(std::min(std::max(v, -1.0f), 1.0f) * 32767.0f));
+}
+
+uint16_t ReferenceUnorm16(float v) {
+    return static_cast<uint16_t>(lrintf(std::min(std::max(v, 0.0f), 1.0f) * 65535.0f));
+}
+
+uint32_t AsBits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+void RandomUnit(std::mt19937& rng, float n[3]) {
+    std::normal_distribution<float> gauss;
+    float len = 0.0f;
+    do {
+        for (int k = 0; k < 3; ++k) n[k] = gauss(rng);
+        len = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    } while (len < 1e-3f);
+    for (int k = 0; k < 3; ++k) n[k] /= len;
+}
+
+std::vector<SourceVertex> MakeVertices(uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(-37.0f, 121.0f);
+    std::uniform_real_distribution<float> uv(-0.1f, 1.1f);
+
+    std::vector<SourceVertex> vertices(VertexCount);
+    for (SourceVertex& v : vertices) {
+        for (float& p : v.pos) p = pos(rng);
+        RandomUnit(rng, v.normal);
+        v.uv[0] = uv(rng);
+        v.uv[1] = uv(rng);
+    }
+    // Оси и рёбра октаэдра, включая -0
+    const float axes[][3] = {
+        { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+        { -0.0f, -0.0f, -1 }, { 0.70710678f, 0, -0.70710678f }, { 0, -0.70710678f, -0.70710678f },
+    };
+    for (size_t i = 0; i < sizeof(axes) / sizeof(axes[0]); ++i) {
+        memcpy(vertices[i * 7 + 1].normal, axes[i], sizeof(axes[i]));
+    }
+    return vertices;
+}
+
+// SSE и скалярный путь совпадают побитово
+void TestMatchesScalar() {
+    std::vector<SourceVertex> vertices = MakeVertices(7);
+    std::vector<PackedVertex> packed(VertexCount);
+    memset(packed.data(), 0xcd, packed.size() * sizeof(PackedVertex));
+
+    QuantizationBounds bounds;
+    ComputeQuantizationBounds(vertices[0].pos, VertexCount, sizeof(SourceVertex), bounds);
+    QuantizePositionsSnorm16(vertices[0].pos, VertexCount, sizeof(SourceVertex), bounds, packed[0].pos, sizeof(PackedVertex));
+    QuantizeNormalsOctahedral(vertices[0].normal, VertexCount, sizeof(SourceVertex), packed[0].normal, sizeof(PackedVertex));
+    QuantizeTexcoordsUnorm16(vertices[0].uv, VertexCount, sizeof(SourceVertex), packed[0].uv, sizeof(PackedVertex));
+
+    int mismatches[3] = {};
+    for (size_t i = 0; i < VertexCount; ++i) {
+        const SourceVertex& v = vertices[i];
+        const PackedVertex& q = packed[i];
+        for (int k = 0; k < 3; ++k) {
+            int16_t expected = ReferenceSnorm16((v.pos[k] - bounds.offset[k]) * (1.0f / bounds.scale[k]));
+            if (q.pos[k] != expected) ++mismatches[0];
+        }
+        if (q.pos[3] != 0) ++mismatches[0];
+
+        int16_t oct[2];
+        EncodeOctahedral(v.normal, oct);
+        if (q.normal[0] != oct[0] || q.normal[1] != oct[1]) ++mismatches[1];
+
+        if (q.uv[0] != ReferenceUnorm16(v.uv[0]) || q.uv[1] != ReferenceUnorm16(v.uv[1])) ++mismatches[2];
+    }
+    CHECK(mismatches[0] == 0);
+    CHECK(mismatches[1] == 0);
+    CHECK(mismatches[2] == 0);
+
+    std::vector<uint16_t> half(VertexCount * 4, 0xcdcd);
+    QuantizePositionsHalf(vertices[0].pos, VertexCount, sizeof(SourceVertex), half.data(), sizeof(uint16_t) * 4);
+    int halfMismatches = 0;
+    for (size_t i = 0; i < VertexCount; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            if (half[i * 4 + k] != FloatToHalf(vertices[i].pos[k])) ++halfMismatches;
+        }
+        if (half[i * 4 + 3] != 0) ++halfMismatches;
+    }
+    CHECK(halfMismatches == 0);
+}
+
+// Особые значения half в каждой дорожке SIMD и в хвосте
+void TestHalfSpecialValues() {
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float smallestHalf = 5.9604645e-8f;
+
+    struct Case {
+        float value;
+        uint16_t expected;
+    };
+    const Case cases[] = {
+        { 0.0f, 0x0000 }, { -0.0f, 0x8000 },
+        { 1.0f, 0x3c00 }, { -2.0f, 0xc000 },
+        { smallestHalf, 0x0001 }, { -smallestHalf, 0x8001 },
+        { smallestHalf * 0.5f, 0x0000 },            // ровно середина, к чётному
+        { smallestHalf * 0.5f * 1.001f, 0x0001 },
+        { 6.097555e-5f, 0x03ff },                   // наибольший денормализованный
+        { 6.1035156e-5f, 0x0400 },                  // наименьший нормализованный
+        { 1e-40f, 0x0000 },                         // денормализованный float
+        { -1e-40f, 0x8000 },
+        { 65504.0f, 0x7bff }, { -65504.0f, 0xfbff },
+        { 65519.0f, 0x7bff },                       // ещё округляется вниз
+        { 65520.0f, 0x7c00 }, { 1e10f, 0x7c00 }, { -1e10f, 0xfc00 },
+        { FLT_MAX, 0x7c00 },
+        { inf, 0x7c00 }, { -inf, 0xfc00 },
+    };
+    const size_t caseCount = sizeof(cases) / sizeof(cases[0]);
+
+    for (size_t c = 0; c < caseCount; ++c) {
+        CHECK(FloatToHalf(cases[c].value) == cases[c].expected);
+    }
+    CHECK((FloatToHalf(nan) & 0x7c00) == 0x7c00 && (FloatToHalf(nan) & 0x3ff) != 0);
+    CHECK((FloatToHalf(-nan) & 0x7fff) == (FloatToHalf(nan) & 0x7fff));
+
+    // Значения в x, y, z вершин со сдвигом, чтобы каждое прошло по всем дорожкам
+    std::vector<float> values;
+    for (const Case& c : cases) values.push_back(c.value);
+    values.push_back(nan);
+    values.push_back(-nan);
+
+    for (size_t shift = 0; shift < 4; ++shift) {
+        size_t count = values.size() + shift;
+        std::vector<float> positions(count * 3);
+        for (size_t i = 0; i < positions.size(); ++i) positions[i] = values[(i + shift) % values.size()];
+
+        std::vector<uint16_t> half(count * 4);
+        QuantizePositionsHalf(positions.data(), count, sizeof(float) * 3, half.data(), sizeof(uint16_t) * 4);
+        for (size_t i = 0; i < count; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                CHECK(half[i * 4 + k] == FloatToHalf(positions[i * 3 + k]));
+            }
+        }
+    }
+
+    // Обратное преобразование сохраняет знак нуля, бесконечности и NaN
+    CHECK(AsBits(HalfToFloat(0x8000)) == 0x80000000u);
+    CHECK(HalfToFloat(0x7c00) == inf && HalfToFloat(0xfc00) == -inf);
+    CHECK(std::isnan(HalfToFloat(0x7e00)));
+    CHECK(HalfToFloat(0x0001) == smallestHalf);
+    CHECK(HalfToFloat(0x7bff) == 65504.0f);
+}
+
+// Ошибка после распаковки не выходит за GetQuantizationErrorBounds
+void TestRoundTripError() {
+    std::vector<SourceVertex> vertices = MakeVertices(11);
+    for (SourceVertex& v : vertices) {
+        v.uv[0] = std::min(std::max(v.uv[0], 0.0f), 1.0f);
+        v.uv[1] = std::min(std::max(v.uv[1], 0.0f), 1.0f);
+    }
+    std::vector<PackedVertex> packed(VertexCount);
+
+    QuantizationBounds bounds;
+    ComputeQuantizationBounds(vertices[0].pos, VertexCount, sizeof(SourceVertex), bounds);
+    QuantizePositionsSnorm16(vertices[0].pos, VertexCount, sizeof(SourceVertex), bounds, packed[0].pos, sizeof(PackedVertex));
+    QuantizeNormalsOctahedral(vertices[0].normal, VertexCount, sizeof(SourceVertex), packed[0].normal, sizeof(PackedVertex));
+    QuantizeTexcoordsUnorm16(vertices[0].uv, VertexCount, sizeof(SourceVertex), packed[0].uv, sizeof(PackedVertex));
+    std::vector<uint16_t> half(VertexCount * 4);
+    QuantizePositionsHalf(vertices[0].pos, VertexCount, sizeof(SourceVertex), half.data(), sizeof(uint16_t) * 4);
+
+    QuantizationErrorBounds limits;
+    GetQuantizationErrorBounds(bounds, limits);
+
+    // Доля использованной границы, худший случай по всем вершинам
+    float worst[4] = {};
+    for (size_t i = 0; i < VertexCount; ++i) {
+        const SourceVertex& v = vertices[i];
+        const PackedVertex& q = packed[i];
+
+        float pos[3];
+        DequantizePositionSnorm16(q.pos, bounds, pos);
+        for (int k = 0; k < 3; ++k) {
+            worst[0] = std::max(worst[0], fabsf(pos[k] - v.pos[k]) / limits.positionSnorm16[k]);
+            float h = HalfToFloat(half[i * 4 + k]);
+            worst[1] = std::max(worst[1], fabsf(h - v.pos[k]) / (fabsf(v.pos[k]) * limits.positionHalfRelative));
+        }
+
+        for (int k = 0; k < 2; ++k) {
+            worst[2] = std::max(worst[2], fabsf(q.uv[k] / 65535.0f - v.uv[k]) / limits.texcoordUnorm16);
+        }
+
+        float n[3];
+        DecodeOctahedral(q.normal, n);
+        // acos около 1 съедает ошибка длины векторов, угол через atan2(|a x b|, a . b)
+        double a[3] = { n[0], n[1], n[2] };
+        double b[3] = { v.normal[0], v.normal[1], v.normal[2] };
+        double cross[3] = { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+        double sinAngle = sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+        float angle = static_cast<float>(atan2(sinAngle, a[0] * b[0] + a[1] * b[1] + a[2] * b[2]));
+        worst[3] = std::max(worst[3], angle / limits.normalOctahedralRadians);
+    }
+    printf("error / bound: snorm16 %.3f, half %.3f, uv %.3f, octahedral %.3f\n", worst[0], worst[1], worst[2], worst[3]);
+    for (float w : worst) CHECK(w <= 1.0f);
+}
+
+// Размеры из GetVertexAttributeDesc совпадают с тем, что пишут Quantize*:
+// при шаге ровно в размер формата байты за последней вершиной не тронуты
+void TestAttributeDescs() {
+    std::vector<SourceVertex> vertices = MakeVertices(13);
+    QuantizationBounds bounds;
+    ComputeQuantizationBounds(vertices[0].pos, VertexCount, sizeof(SourceVertex), bounds);
+
+    const VertexAttributeFormat formats[] = {
+        VertexAttributeFormat::PositionSnorm16, VertexAttributeFormat::PositionHalf,
+        VertexAttributeFormat::TexcoordUnorm16, VertexAttributeFormat::NormalOctahedral,
+    };
+    for (VertexAttributeFormat format : formats) {
+        const VertexAttributeDesc& desc = GetVertexAttributeDesc(format);
+        const size_t Guard = 16;
+        std::vector<uint8_t> tight(VertexCount * desc.size + Guard, 0xcd);
+        std::vector<uint8_t> wide(VertexCount * 16, 0xcd);
+
+        auto encode = [&](uint8_t* out, size_t outStride) {
+            switch (format) {
+            case VertexAttributeFormat::PositionSnorm16:
+                QuantizePositionsSnorm16(vertices[0].pos, VertexCount, sizeof(SourceVertex), bounds, out, outStride);
+                break;
+            case VertexAttributeFormat::PositionHalf:
+                QuantizePositionsHalf(vertices[0].pos, VertexCount, sizeof(SourceVertex), out, outStride);
+                break;
+            case VertexAttributeFormat::TexcoordUnorm16:
+                QuantizeTexcoordsUnorm16(vertices[0].uv, VertexCount, sizeof(SourceVertex), out, outStride);
+                break;
+            case VertexAttributeFormat::NormalOctahedral:
+                QuantizeNormalsOctahedral(vertices[0].normal, VertexCount, sizeof(SourceVertex), out, outStride);
+                break;
+            }
+        };
+        encode(tight.data(), desc.size);
+        encode(wide.data(), 16);
+
+        bool same = true;
+        for (size_t i = 0; i < VertexCount; ++i) {
+            same = same && memcmp(&tight[i * desc.size], &wide[i * 16], desc.size) == 0;
+            // Всё за размером формата остаётся нетронутым
+            for (size_t b = desc.size; b < 16; ++b) same = same && wide[i * 16 + b] == 0xcd;
+        }
+        CHECK(same);
+        for (size_t b = 0; b < Guard; ++b) CHECK(tight[VertexCount * desc.size + b] == 0xcd);
+    }
+
+    CHECK(GetVertexAttributeDesc(VertexAttributeFormat::PositionSnorm16).size == sizeof(int16_t) * 4);
+    CHECK(GetVertexAttributeDesc(VertexAttributeFormat::NormalOctahedral).size == sizeof(int16_t) * 2);
+}
+
+}
+
+int main() {
+    TestMatchesScalar();
+    TestAttributeDescs();
+    TestHalfSpecialValues();
+    TestRoundTripError();
+    return TestResult("VertexQuantization");
+}
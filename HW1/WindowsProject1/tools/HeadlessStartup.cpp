@@ -0,0 +1,18 @@
+#include "SceneStartup.h"
+
+#include <cstdio>
+#include <fstream>
+
+// Замер стадий старта без окна и устройства: HeadlessStartup [assets] [report.txt]
+int main(int argc, char** argv) {
+    std::filesystem::path assetsDir = argc > 1 ? argv[1] : ASSETS_DIR;
+    std::string report = RunHeadlessStartup(assetsDir);
+    fputs(report.c_str(), stdout);
+
+    if (argc > 2) {
+        std::ofstream file(argv[2]);
+        file << report;
+        if (!file) return 1;
+    }
+    return 0;
+}